@@ -0,0 +1,119 @@
+// ASCII case conversion and validation kernels against the per-character <cctype> loops they replaced
+// g++ -std=c++17 -O2 -o ascii_bench bench/ascii_bench.cpp && ./ascii_bench [iterations]
+#define GPA_NO_MAIN
+#include "../src/GPA.cpp"
+#include <random>
+
+// the loops the prompts used before the kernels
+static void legacyUppercase(std::string& s)
+{
+    for (auto &c : s) c = toupper(c);
+}
+
+static bool legacyIsDigits(const std::string& s)
+{
+    for (auto &c : s) {
+        if (!isdigit(c)) return false;
+    }
+    return true;
+}
+
+static bool legacyIsAlphabets(const std::string& s)
+{
+    for (auto &c : s) {
+        if (!isalpha(c)) return false;
+    }
+    return true;
+}
+
+static volatile size_t benchSink; // keeps the work from being optimized away
+
+// module names, as they would be typed, of about the given length
+static std::vector<std::string> makeNames(const size_t length, const size_t count, std::mt19937& rng)
+{
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+    std::vector<std::string> names(count);
+    for (std::string& name : names) {
+        for (size_t i = 0; i < length; i++) name += letters[rng() % (sizeof(letters) - 1)];
+    }
+    return names;
+}
+
+template <typename Fn>
+static double nsPerName(std::vector<std::string> names, const size_t iterations, Fn fn)
+{
+    size_t result = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) result += fn(names[i % names.size()]);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    benchSink = result;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+// every kernel has to agree with the scalar one, including on bytes outside ASCII
+static bool kernelsAgree(const AsciiKernels& kernels, std::mt19937& rng)
+{
+    for (size_t length = 0; length < 200; length++) {
+        for (int round = 0; round < 50; round++) {
+            std::string input(length, ' ');
+            for (char& c : input) c = (char)(round % 3 == 0 ? '0' + rng() % 10 : rng() % 256);
+            std::string expected = input, actual = input;
+            flipCaseScalar(expected.data(), expected.size(), 'a', 'z');
+            kernels.flipCase(actual.data(), actual.size(), 'a', 'z');
+            if (expected != actual) return false;
+            if (allInRangeScalar(input.data(), input.size(), '0', '9', 0) != kernels.allInRange(input.data(), input.size(), '0', '9', 0)) return false;
+            if (allInRangeScalar(input.data(), input.size(), 'a', 'z', 0x20) != kernels.allInRange(input.data(), input.size(), 'a', 'z', 0x20)) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::mt19937 rng(7);
+
+    std::vector<const AsciiKernels*> kernels = { &scalarAsciiKernels };
+#ifdef GPA_ASCII_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(&sse2AsciiKernels);
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(&avx2AsciiKernels);
+#endif
+    for (const AsciiKernels* k : kernels) {
+        if (!kernelsAgree(*k, rng)) {
+            std::cout << k->name << " kernels do not match the scalar ones\n";
+            return 1;
+        }
+    }
+    std::cout << "selected: " << asciiKernels().name << ", " << iterations << " names per run, ns/name\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (size_t length : { 8, 16, 24, 40, 64 }) {
+        std::vector<std::string> names = makeNames(length, 1024, rng);
+        std::vector<std::string> digits(names.size(), std::string(length, '7'));
+        std::cout << "\nlength " << length << "\n";
+        std::cout << "  uppercase    <cctype> " << nsPerName(names, iterations, [](std::string& s) { legacyUppercase(s); return (size_t)s[0]; });
+        for (const AsciiKernels* k : kernels) {
+            std::cout << "  " << k->name << " " << nsPerName(names, iterations, [k](std::string& s) {
+                k->flipCase(s.data(), s.size(), 'a', 'z');
+                return (size_t)s[0];
+            });
+        }
+        std::cout << "\n  digits       <cctype> " << nsPerName(digits, iterations, [](std::string& s) { return (size_t)legacyIsDigits(s); });
+        for (const AsciiKernels* k : kernels) {
+            std::cout << "  " << k->name << " " << nsPerName(digits, iterations, [k](std::string& s) {
+                return (size_t)k->allInRange(s.data(), s.size(), '0', '9', 0);
+            });
+        }
+        std::vector<std::string> letters = names;
+        for (std::string& s : letters) std::replace(s.begin(), s.end(), ' ', 'x');
+        std::cout << "\n  alphabets    <cctype> " << nsPerName(letters, iterations, [](std::string& s) { return (size_t)legacyIsAlphabets(s); });
+        for (const AsciiKernels* k : kernels) {
+            std::cout << "  " << k->name << " " << nsPerName(letters, iterations, [k](std::string& s) {
+                return (size_t)k->allInRange(s.data(), s.size(), 'a', 'z', 0x20);
+            });
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// lookup throughput of module names typed in any casing, and of the prefix searches behind the edit/remove prompts
+// g++ -std=c++17 -O2 -o lookup_bench bench/lookup_bench.cpp && ./lookup_bench [modules] [lookups]
+//
+// "title-cased copy" is how names used to be looked up: the input was copied, title-cased and then matched
+// exactly, "folded key" looks the input up as it is typed against the folded keys kept in the store
+// "prefix" is what a prompt does with the start of a name: count the matches, list the first few and complete it
+// "similar" is the suggestion for a misspelt name that was not found, after the trigram index has been built
+#define GPA_NO_MAIN
+#include "../src/GPA.cpp"
+#include <random>
+
+// the name normalization done on every prompt before the folded keys
+static void legacyTitleInput(std::string& s)
+{
+    int toUpper = 1;
+    for (auto &c : s) {
+        if (toUpper) {
+            c = toupper(c);
+            toUpper = 0;
+        } else if (isspace(c)) {
+            toUpper = 1;
+        } else {
+            c = tolower(c);
+        }
+    }
+}
+
+static std::string randomModuleName(std::mt19937& rng)
+{
+    static const char* words[] = { "data", "structures", "algorithms", "operating", "systems", "network", "security",
+        "database", "design", "mathematics", "programming", "web", "applications", "mobile", "cloud", "computing" };
+    std::string name;
+    size_t wordCount = 1 + rng() % 4;
+    for (size_t i = 0; i < wordCount; i++) {
+        if (i) name += ' ';
+        name += words[rng() % (sizeof(words) / sizeof(words[0]))];
+    }
+    return name + ' ' + std::to_string(rng() % 1000);
+}
+
+// the same name as a user might type it
+static std::string randomCasing(std::string name, std::mt19937& rng)
+{
+    for (char& c : name) {
+        if (rng() % 3 == 0) c = (char)toupper(c);
+    }
+    return name;
+}
+
+static volatile size_t lookupSink; // keeps the lookups from being optimized away
+
+template <typename Fn>
+static double nsPerLookup(const std::vector<std::string>& queries, const size_t lookups, Fn lookup)
+{
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) found += lookup(queries[i % queries.size()]);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    lookupSink = found;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / lookups;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t moduleCount = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 5000000;
+
+    std::mt19937 rng(42);
+    ModuleStore store;
+    std::vector<std::string> queries;
+    store.beginBulkLoad();
+    while (store.size() < moduleCount) {
+        std::string name = randomModuleName(rng);
+        legacyTitleInput(name);
+        store.load(name, GradeCode::A, 4);
+    }
+    store.endBulkLoad();
+    store.forEach([&](std::string_view name, const ModuleRecord&) { queries.push_back(randomCasing(std::string(name), rng)); });
+    std::shuffle(queries.begin(), queries.end(), rng);
+
+    double legacy = nsPerLookup(queries, lookups, [&store](const std::string& query) {
+        std::string name = query;
+        legacyTitleInput(name);
+        return store.contains(name);
+    });
+    double folded = nsPerLookup(queries, lookups, [&store](const std::string& query) { return store.contains(query); });
+
+    std::cout << moduleCount << " modules, " << lookups << " lookups\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "title-cased copy: " << legacy << " ns/lookup\n";
+    std::cout << "folded key:       " << folded << " ns/lookup\n";
+
+    for (size_t prefixLength : { 1, 3, 6, 12 }) {
+        std::vector<std::string> prefixes;
+        for (const std::string& query : queries) prefixes.push_back(query.substr(0, prefixLength));
+        size_t prefixLookups = std::max<size_t>(lookups / 20, 1);
+        double prefix = nsPerLookup(prefixes, prefixLookups, [&store](const std::string& query) {
+            size_t listed = 0;
+            store.forEachWithPrefix(query, promptListLimit, [&listed](std::string_view, const ModuleRecord&) { listed++; });
+            return store.countWithPrefix(query) + store.completePrefix(query).size() + listed;
+        });
+        std::cout << "prefix of " << std::setw(2) << prefixLength << ":     " << prefix << " ns/search\n";
+    }
+
+    // one letter dropped from each name
+    std::vector<std::string> misspelt;
+    for (const std::string& query : queries) misspelt.push_back(query.substr(0, query.size() / 2) + query.substr(query.size() / 2 + 1));
+    auto start = std::chrono::steady_clock::now();
+    store.similarNames("", suggestionLimit);
+    double indexing = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t similarLookups = std::max<size_t>(lookups / 5000, 1);
+    double similar = nsPerLookup(misspelt, similarLookups, [&store](const std::string& query) {
+        return store.similarNames(query, suggestionLimit).size();
+    });
+    std::cout << "trigram index:    " << indexing << " ms to build\n";
+    std::cout << "similar:          " << similar / 1000 << " us/search\n";
+    return 0;
+}
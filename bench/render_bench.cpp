@@ -0,0 +1,53 @@
+// module listing through std::cout field by field against ModuleListRenderer
+// g++ -std=c++17 -O2 -o render_bench bench/render_bench.cpp && ./render_bench [modules] > /dev/null
+// the listings go to stdout so that they can be sent to a terminal, a pipe or /dev/null, the timings go to stderr
+#define GPA_NO_MAIN
+#include "../src/GPA.cpp"
+#include <random>
+
+// the listing as it was printed before the renderer, copying every module out and streaming every field
+static void legacyListing(const ModuleStore& gpaMap)
+{
+    gpaMap.forEach([](std::string_view name, const ModuleRecord& record) {
+        auto moduleName = std::string(name);
+        auto value = record;
+        std::cout << "- " << moduleName << " (" << value.credit << "): " << gradeName(value.grade) << "\n";
+    });
+}
+
+template <typename Fn>
+static double msFor(Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::cout.flush();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t moduleCount = argc > 1 ? std::stoul(argv[1]) : 50000;
+    std::mt19937 rng(5);
+    ModuleStore store;
+    store.beginBulkLoad();
+    for (size_t i = 0; i < moduleCount; i++) {
+        store.load("Module " + std::to_string(rng()) + " Year " + std::to_string(i % 4 + 1), (GradeCode)(rng() % 10), (int)(rng() % 10));
+    }
+    store.endBulkLoad();
+
+    std::istringstream noInput;
+    double legacy = msFor([&store]() { legacyListing(store); });
+    double byName = msFor([&]() { renderModuleList(store, ListOptions(), std::cout, noInput); });
+    ListOptions byGrade;
+    byGrade.sort = SORT_BY_GRADE;
+    double gradeFirst = msFor([&]() { renderModuleList(store, byGrade, std::cout, noInput); });
+    double gradeCached = msFor([&]() { renderModuleList(store, byGrade, std::cout, noInput); });
+
+    std::cerr << moduleCount << " modules, ms per listing\n";
+    std::cerr << std::fixed << std::setprecision(2);
+    std::cerr << "field by field:          " << legacy << "\n";
+    std::cerr << "renderer, by name:       " << byName << "\n";
+    std::cerr << "renderer, by grade:      " << gradeFirst << " (sorting)\n";
+    std::cerr << "renderer, by grade:      " << gradeCached << " (cached order)\n";
+    return 0;
+}
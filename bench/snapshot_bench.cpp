@@ -0,0 +1,113 @@
+// GPA queries from 1 to N reader threads while one writer keeps changing modules, reading published snapshots
+// against reading the live store under a mutex
+// g++ -std=c++17 -O2 -pthread -o snapshot_bench bench/snapshot_bench.cpp && ./snapshot_bench [modules] [max readers] [ms per run]
+#define GPA_NO_MAIN
+#include "../src/GPA.cpp"
+#include <random>
+
+struct RunResult {
+    double queriesPerSecond = 0; // over all readers
+    double writesPerSecond = 0;
+    bool consistent = true;
+};
+
+// a reader's query: the GPA of every module in the snapshot, which has to match the totals it was published with
+static RunResult runSnapshots(ModuleStore store, const size_t readers, const std::chrono::milliseconds duration)
+{
+    SnapshotPublisher publisher;
+    publisher.publish(store);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<bool> consistent{true};
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < readers; i++) {
+        threads.emplace_back([&]() {
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::shared_ptr<const ModuleSnapshot> snapshot = publisher.acquire();
+                GPAAggregate agg = calculateGPA(snapshot->modules);
+                if (formatGPA(agg) != snapshot->gpa) consistent = false;
+                done++;
+            }
+            queries += done;
+        });
+    }
+
+    std::mt19937 rng(11);
+    uint64_t writes = 0;
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        store.load("Module " + std::to_string(rng() % store.size()), (GradeCode)(rng() % 10), (int)(rng() % 10));
+        publisher.publish(store);
+        writes++;
+    }
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+
+    double seconds = std::chrono::duration<double>(duration).count();
+    return { queries / seconds, writes / seconds, consistent.load() };
+}
+
+// the same queries on the live store, with the writer holding the lock for each change
+static RunResult runMutex(ModuleStore store, const size_t readers, const std::chrono::milliseconds duration)
+{
+    std::mutex lock;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<bool> consistent{true};
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < readers; i++) {
+        threads.emplace_back([&]() {
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> guard(lock);
+                GPAAggregate agg = calculateGPA(store);
+                if (agg.totalPoints != store.totals().totalPoints) consistent = false;
+                done++;
+            }
+            queries += done;
+        });
+    }
+
+    std::mt19937 rng(11);
+    uint64_t writes = 0;
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        std::string name = "Module " + std::to_string(rng() % store.size());
+        std::lock_guard<std::mutex> guard(lock);
+        store.load(name, (GradeCode)(rng() % 10), (int)(rng() % 10));
+        writes++;
+    }
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+
+    double seconds = std::chrono::duration<double>(duration).count();
+    return { queries / seconds, writes / seconds, consistent.load() };
+}
+
+int main(int argc, char* argv[])
+{
+    size_t moduleCount = argc > 1 ? std::stoul(argv[1]) : 2000;
+    size_t maxReaders = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency() - 1);
+    std::chrono::milliseconds duration(argc > 3 ? std::stoul(argv[3]) : 500);
+
+    ModuleStore store;
+    store.beginBulkLoad();
+    for (size_t i = 0; i < moduleCount; i++) store.load("Module " + std::to_string(i), GradeCode::A, 4);
+    store.endBulkLoad();
+
+    std::cout << moduleCount << " modules, one writer, " << duration.count() << " ms per run\n";
+    std::cout << "readers  snapshot queries/s  writes/s   mutex queries/s  writes/s\n";
+    bool consistent = true;
+    for (size_t readers = 1; readers <= maxReaders; readers *= 2) {
+        RunResult snapshot = runSnapshots(store, readers, duration);
+        RunResult mutex = runMutex(store, readers, duration);
+        consistent = consistent && snapshot.consistent && mutex.consistent;
+        std::cout << std::setw(7) << readers << std::setw(20) << (uint64_t)snapshot.queriesPerSecond << std::setw(10) << (uint64_t)snapshot.writesPerSecond
+                  << std::setw(18) << (uint64_t)mutex.queriesPerSecond << std::setw(10) << (uint64_t)mutex.writesPerSecond << "\n";
+    }
+    if (!consistent) std::cout << "a reader saw totals that did not match its modules\n";
+    return consistent ? 0 : 1;
+}
@@ -10,254 +10,2302 @@
 #include <iomanip>
 #include <thread>
 #include <limits>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <charconv>
+#include <type_traits>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GPA_ASCII_SIMD // SSE2/AVX2 versions of the ASCII kernels, picked at runtime
+#include <immintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 #include "../dep/jsoncpp/jsoncpp.cpp" // relies on jsoncpp at https://github.com/open-source-parsers/jsoncpp
 
-typedef std::map<std::string, std::tuple<std::string, int>> gpaHashMapStruc;
+// interned grade, the code is the index of the grade in gradeTable and is also what gpa.bin stores
+enum class GradeCode : uint8_t { DIST, A, B_PLUS, B, C_PLUS, C, D_PLUS, D, F, P, INVALID };
 
 const std::string version = "0.2.0";
 
-Json::Reader reader;
-Json::Value root;
 const std::string jsonFile = "gpa.json";
 
+// when enabled, each change is appended to the journal instead of rewriting the whole gpa.json
+bool journalMode = true;
+const std::string journalFile = "gpa.journal";
+const int journalCompactThreshold = 200; // number of journal records before they are folded back into gpa.json
+int journalEntries = 0;
+
+// when enabled, saveToPC also writes a binary copy of gpa.json that is loaded instead of it when it is up to date
+bool binarySnapshot = true;
+const std::string binaryFile = "gpa.bin";
+
+// minimum time between two fsyncs of the save files, changes made in between are committed together
+const std::chrono::milliseconds groupCommitWindow(50);
+
+// the most modules listed at the edit/remove prompts, a longer transcript is narrowed down by typing the start of a name
+const size_t promptListLimit = 10;
+// how many similar names are suggested when a module is not found
+const size_t suggestionLimit = 3;
+
+// the most threads --jobs may ask for
+const size_t maxJobs = 1024;
+
 const std::string errorLogFile = "error-log-v" + version + ".log";
 
-// based on https://www.nyp.edu.sg/current-students/academic-matters/nyp-assessment-regulations.html
-const std::map<std::string, float> gpaRef = {
-    {"DIST", 4.0}, // awarded by the Assessment Board, though it is the same as grade A
-    {"A", 4.0},
-    {"B+", 3.5},
-    {"B", 3.0},
-    {"C+", 2.5},
-    {"C", 2.0},
-    {"D+", 1.5},
-    {"D", 1.0},
-    {"F", 0.0},
-    {"P", 0.0} // p for pass (GSM), will not be used during calculation of GPA
+// grade points are kept in hundredths so that the GPA can be accumulated exactly with integers
+constexpr int gradePointScale = 100;
+
+struct GradeInfo {
+    const char* name;
+    int points; // grade points * gradePointScale
+};
+
+// based on https://www.nyp.edu.sg/current-students/academic-matters/nyp-assessment-regulations.html
+// ordered by GradeCode, so new grades must only be appended (names can be at most 4 characters long)
+constexpr GradeInfo gradeTable[] = {
+    {"DIST", 400}, // awarded by the Assessment Board, though it is the same as grade A
+    {"A", 400},
+    {"B+", 350},
+    {"B", 300},
+    {"C+", 250},
+    {"C", 200},
+    {"D+", 150},
+    {"D", 100},
+    {"F", 0},
+    {"P", 0} // p for pass (GSM), will not be used during calculation of GPA
+};
+constexpr size_t gradeCount = sizeof(gradeTable) / sizeof(gradeTable[0]);
+static_assert(gradeCount == (size_t)GradeCode::INVALID, "gradeTable must have an entry for every GradeCode");
+
+// packs an uppercased grade of up to 4 ASCII characters into an integer, 0 if it cannot be a grade
+constexpr uint32_t packGrade(const std::string_view grade)
+{
+    if (grade.empty() || grade.size() > 4) return 0;
+    uint32_t key = 0;
+    for (char c : grade) {
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        key = (key << 8) | (unsigned char)c;
+    }
+    return key;
+}
+
+// the grade lookup is a perfect hash, (key * gradeHashSeed) >> 28 gives every grade in gradeTable its own slot out of 16
+constexpr size_t gradeSlotCount = 16;
+
+constexpr size_t gradeSlot(const uint32_t key, const uint32_t seed)
+{
+    return (uint32_t)(key * seed) >> 28;
+}
+
+constexpr uint32_t findGradeHashSeed()
+{
+    for (uint32_t attempt = 1; attempt < 100000; attempt++) {
+        uint32_t seed = (attempt * 2654435761u) | 1; // spread the candidates so that the top bits get mixed
+        bool used[gradeSlotCount] = {};
+        bool collision = false;
+        for (size_t i = 0; i < gradeCount && !collision; i++) {
+            size_t slot = gradeSlot(packGrade(gradeTable[i].name), seed);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) return seed;
+    }
+    return 0;
+}
+
+constexpr uint32_t gradeHashSeed = findGradeHashSeed();
+static_assert(gradeHashSeed != 0, "no perfect hash found for gradeTable");
+
+constexpr std::array<GradeCode, gradeSlotCount> buildGradeSlots()
+{
+    std::array<GradeCode, gradeSlotCount> slots = {};
+    for (auto& slot : slots) slot = GradeCode::INVALID;
+    for (size_t i = 0; i < gradeCount; i++) slots[gradeSlot(packGrade(gradeTable[i].name), gradeHashSeed)] = (GradeCode)i;
+    return slots;
+}
+
+constexpr std::array<GradeCode, gradeSlotCount> gradeSlots = buildGradeSlots();
+
+// validates the grade (case-insensitive) and returns its code, GradeCode::INVALID if it is not in gradeTable
+constexpr GradeCode internGrade(const std::string_view grade)
+{
+    uint32_t key = packGrade(grade);
+    GradeCode code = gradeSlots[gradeSlot(key, gradeHashSeed)];
+    if (code == GradeCode::INVALID || packGrade(gradeTable[(size_t)code].name) != key) return GradeCode::INVALID;
+    return code;
+}
+
+constexpr const char* gradeName(const GradeCode code)
+{
+    return code < GradeCode::INVALID ? gradeTable[(size_t)code].name : "INVALID";
+}
+
+// grade points * gradePointScale
+constexpr int gradePoints(const GradeCode code)
+{
+    return code < GradeCode::INVALID ? gradeTable[(size_t)code].points : -gradePointScale;
+}
+
+static_assert(internGrade("b+") == GradeCode::B_PLUS && internGrade("Dist") == GradeCode::DIST, "grade lookup is broken");
+static_assert(internGrade("") == GradeCode::INVALID && internGrade("B-") == GradeCode::INVALID && internGrade("DISTS") == GradeCode::INVALID, "grade lookup is broken");
+
+// builds a message out of text and numbers with std::to_chars, so formatting a number never throws and never depends on
+// the locale or on the flags left set on a stream, the builder can be cleared and reused without allocating again
+class TextBuilder {
+public:
+    TextBuilder& operator<<(const std::string_view s)
+    {
+        text.append(s.data(), s.size());
+        return *this;
+    }
+
+    TextBuilder& operator<<(const char* s) { return *this << std::string_view(s); }
+
+    TextBuilder& operator<<(const char c)
+    {
+        text += c;
+        return *this;
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    TextBuilder& operator<<(const T value)
+    {
+        char digits[24];
+        text.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        return *this;
+    }
+
+    // value / 10^prec with exactly prec decimal places, for numbers kept as scaled integers
+    TextBuilder& scaled(int64_t value, const int prec)
+    {
+        if (value < 0) {
+            text += '-';
+            value = -value;
+        }
+        int64_t scale = 1;
+        for (int i = 0; i < prec; i++) scale *= 10;
+        *this << value / scale;
+        if (prec > 0) {
+            char digits[24];
+            char* end = std::to_chars(digits, digits + sizeof(digits), value % scale).ptr;
+            text += '.';
+            text.append(prec - (end - digits), '0');
+            text.append(digits, end);
+        }
+        return *this;
+    }
+
+    const std::string& str() const { return text; }
+    size_t size() const { return text.size(); }
+    void clear() { text.clear(); }
+
+private:
+    std::string text;
+};
+
+// exact totals of the modules, the GPA is totalPoints / (totalCredits * gradePointScale) and is only rounded when displayed
+struct GPAAggregate {
+    int64_t totalCredits = 0;
+    int64_t totalPoints = 0; // sum of grade points * gradePointScale * credits
+};
+
+// applies (sign = 1) or takes back (sign = -1) a module's contribution, used to keep the totals up to date without a full recalculation
+void updateAggregate(GPAAggregate& agg, const GradeCode grade, const int credits, const int sign = 1)
+{
+    if (grade == GradeCode::P) return;
+    agg.totalCredits += sign * (int64_t)credits;
+    agg.totalPoints += sign * (int64_t)gradePoints(grade) * credits;
+}
+
+// GPA rounded half away from zero to prec decimal places, or "N/A" if there are no graded credits yet
+std::string formatGPA(const GPAAggregate& agg, const int prec = 2)
+{
+    if (agg.totalCredits == 0) return "N/A";
+
+    int64_t scale = 1;
+    for (int i = 0; i < prec; i++) scale *= 10;
+    int64_t num = agg.totalPoints * scale;
+    int64_t den = agg.totalCredits * gradePointScale;
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+    bool negative = num < 0;
+    if (negative) num = -num;
+    int64_t rounded = (2 * num + den) / (2 * den);
+
+    TextBuilder result;
+    result.scaled(negative ? -rounded : rounded, prec);
+    return result.str();
+}
+
+struct ModuleRecord {
+    GradeCode grade = GradeCode::INVALID;
+    int credit = 0;
+
+    bool operator==(const ModuleRecord& other) const { return grade == other.grade && credit == other.credit; }
+};
+
+// ASCII case conversion and validation, run on every prompt and on every loaded or imported module name
+// only ASCII letters and digits are recognised (independent of the locale), any other byte is left as it is
+struct AsciiKernels {
+    const char* name;
+    // flips the case bit of every byte in [low, high], so 'a'..'z' uppercases and 'A'..'Z' lowercases
+    void (*flipCase)(char* data, size_t size, char low, char high);
+    // whether every byte is in [low, high] after or'ing orMask into it
+    bool (*allInRange)(const char* data, size_t size, char low, char high, char orMask);
+};
+
+void flipCaseScalar(char* data, const size_t size, const char low, const char high)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] >= low && data[i] <= high) data[i] ^= 0x20;
+    }
+}
+
+bool allInRangeScalar(const char* data, const size_t size, const char low, const char high, const char orMask)
+{
+    for (size_t i = 0; i < size; i++) {
+        char c = (char)(data[i] | orMask);
+        if (c < low || c > high) return false;
+    }
+    return true;
+}
+
+const AsciiKernels scalarAsciiKernels = { "scalar", flipCaseScalar, allInRangeScalar };
+
+#ifdef GPA_ASCII_SIMD
+// bytes of 0x80 and above are negative to the signed compares, so they are never in range
+__attribute__((target("sse2"))) void flipCaseSSE2(char* data, const size_t size, const char low, const char high)
+{
+    const __m128i below = _mm_set1_epi8((char)(low - 1)), above = _mm_set1_epi8((char)(high + 1)), caseBit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(bytes, below), _mm_cmplt_epi8(bytes, above));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(bytes, _mm_and_si128(inRange, caseBit)));
+    }
+    flipCaseScalar(data + i, size - i, low, high);
+}
+
+__attribute__((target("sse2"))) bool allInRangeSSE2(const char* data, const size_t size, const char low, const char high, const char orMask)
+{
+    const __m128i below = _mm_set1_epi8((char)(low - 1)), above = _mm_set1_epi8((char)(high + 1)), mask = _mm_set1_epi8(orMask);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i)), mask);
+        __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(bytes, below), _mm_cmplt_epi8(bytes, above));
+        if (_mm_movemask_epi8(inRange) != 0xFFFF) return false;
+    }
+    return allInRangeScalar(data + i, size - i, low, high, orMask);
+}
+
+__attribute__((target("avx2"))) void flipCaseAVX2(char* data, const size_t size, const char low, const char high)
+{
+    const __m256i below = _mm256_set1_epi8((char)(low - 1)), above = _mm256_set1_epi8((char)(high + 1)), caseBit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, below), _mm256_cmpgt_epi8(above, bytes));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(bytes, _mm256_and_si256(inRange, caseBit)));
+    }
+    // the 16 byte step is done here instead of calling the SSE2 kernel, which would mix in non-VEX instructions
+    if (i + 16 <= size) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm256_castsi256_si128(below)), _mm_cmplt_epi8(bytes, _mm256_castsi256_si128(above)));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(bytes, _mm_and_si128(inRange, _mm256_castsi256_si128(caseBit))));
+        i += 16;
+    }
+    flipCaseScalar(data + i, size - i, low, high);
+}
+
+__attribute__((target("avx2"))) bool allInRangeAVX2(const char* data, const size_t size, const char low, const char high, const char orMask)
+{
+    const __m256i below = _mm256_set1_epi8((char)(low - 1)), above = _mm256_set1_epi8((char)(high + 1)), mask = _mm256_set1_epi8(orMask);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(data + i)), mask);
+        __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, below), _mm256_cmpgt_epi8(above, bytes));
+        if (_mm256_movemask_epi8(inRange) != -1) return false;
+    }
+    if (i + 16 <= size) {
+        __m128i bytes = _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i)), _mm256_castsi256_si128(mask));
+        __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm256_castsi256_si128(below)), _mm_cmplt_epi8(bytes, _mm256_castsi256_si128(above)));
+        if (_mm_movemask_epi8(inRange) != 0xFFFF) return false;
+        i += 16;
+    }
+    return allInRangeScalar(data + i, size - i, low, high, orMask);
+}
+
+const AsciiKernels sse2AsciiKernels = { "sse2", flipCaseSSE2, allInRangeSSE2 };
+const AsciiKernels avx2AsciiKernels = { "avx2", flipCaseAVX2, allInRangeAVX2 };
+#endif
+
+// the widest kernels the CPU supports, checked once
+const AsciiKernels& asciiKernels()
+{
+    static const AsciiKernels& selected = []() -> const AsciiKernels& {
+#ifdef GPA_ASCII_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return avx2AsciiKernels;
+        if (__builtin_cpu_supports("sse2")) return sse2AsciiKernels;
+#endif
+        return scalarAsciiKernels;
+    }();
+    return selected;
+}
+
+// strings shorter than one vector go straight to the scalar loop
+constexpr size_t asciiVectorSize = 16;
+
+void asciiUppercase(char* data, const size_t size)
+{
+    if (size < asciiVectorSize) flipCaseScalar(data, size, 'a', 'z');
+    else asciiKernels().flipCase(data, size, 'a', 'z');
+}
+
+void asciiLowercase(char* data, const size_t size)
+{
+    if (size < asciiVectorSize) flipCaseScalar(data, size, 'A', 'Z');
+    else asciiKernels().flipCase(data, size, 'A', 'Z');
+}
+
+bool asciiAllInRange(const std::string_view s, const char low, const char high, const char orMask = 0)
+{
+    if (s.size() < asciiVectorSize) return allInRangeScalar(s.data(), s.size(), low, high, orMask);
+    return asciiKernels().allInRange(s.data(), s.size(), low, high, orMask);
+}
+
+bool isAsciiUppercase(const std::string_view s) { return asciiAllInRange(s, 'A', 'Z'); }
+bool isAsciiDigits(const std::string_view s) { return asciiAllInRange(s, '0', '9'); }
+// or'ing in the case bit maps 'A'..'Z' onto 'a'..'z' and nothing else onto it
+bool isAsciiAlphabets(const std::string_view s) { return asciiAllInRange(s, 'a', 'z', 0x20); }
+
+// module names are matched without regard to ASCII case through a folded key (the name in lowercase), while the
+// display name keeps the casing it was entered with, so that "OOP" stays "OOP" but can still be found as "oop"
+constexpr char foldChar(const char c) { return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c; }
+
+std::string foldName(const std::string_view name)
+{
+    std::string key(name);
+    asciiLowercase(key.data(), key.size());
+    return key;
+}
+
+bool foldedEquals(const std::string_view a, const std::string_view b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (foldChar(a[i]) != foldChar(b[i])) return false;
+    }
+    return true;
+}
+
+bool foldedStartsWith(const std::string_view name, const std::string_view prefix)
+{
+    return name.size() >= prefix.size() && foldedEquals(name.substr(0, prefix.size()), prefix);
+}
+
+// FNV-1a over the folded key, without building it
+struct FoldedHash {
+    uint32_t operator()(const std::string_view name) const
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : name) hash = (hash ^ (unsigned char)foldChar(c)) * 16777619u;
+        return hash;
+    }
+};
+
+// orders names by their folded keys, transparent so that maps keyed on it can be searched with a string_view
+struct FoldedLess {
+    using is_transparent = void;
+
+    bool operator()(const std::string_view a, const std::string_view b) const
+    {
+        size_t length = std::min(a.size(), b.size());
+        for (size_t i = 0; i < length; i++) {
+            char x = foldChar(a[i]), y = foldChar(b[i]);
+            if (x != y) return (unsigned char)x < (unsigned char)y;
+        }
+        return a.size() < b.size();
+    }
+};
+
+// orders the module listing can be sorted in, grade and credit are best/highest first with ties in name order
+enum ModuleSort { SORT_BY_NAME, SORT_BY_GRADE, SORT_BY_CREDIT };
+
+// inverted index from the trigrams of the folded module keys to the ids of the modules containing them, used to
+// suggest similar names when one is not found without comparing the name against every module
+// keys are padded as "  key " so that the start of a name weighs more and names of one or two characters still have
+// trigrams, the posting lists are unordered so that an id is removed by swapping it with the last one
+class TrigramIndex {
+public:
+    struct Match {
+        uint32_t id;
+        double score;
+    };
+
+    void add(const uint32_t id, const std::string_view key)
+    {
+        std::vector<uint32_t> keyTrigrams = trigrams(key);
+        for (uint32_t trigram : keyTrigrams) postings[trigram].push_back(id);
+        if (trigramCounts.size() <= id) trigramCounts.resize(id + 1);
+        trigramCounts[id] = (uint32_t)keyTrigrams.size();
+    }
+
+    void remove(const uint32_t id, const std::string_view key)
+    {
+        for (uint32_t trigram : trigrams(key)) {
+            auto entry = postings.find(trigram);
+            std::vector<uint32_t>& ids = entry->second;
+            *std::find(ids.begin(), ids.end(), id) = ids.back();
+            ids.pop_back();
+            if (ids.empty()) postings.erase(entry);
+        }
+        trigramCounts[id] = 0;
+    }
+
+    // the module with id from now has id to
+    void renumber(const uint32_t from, const uint32_t to, const std::string_view key)
+    {
+        for (uint32_t trigram : trigrams(key)) {
+            std::vector<uint32_t>& ids = postings[trigram];
+            *std::find(ids.begin(), ids.end(), from) = to;
+        }
+        if (trigramCounts.size() <= to) trigramCounts.resize(to + 1);
+        trigramCounts[to] = trigramCounts[from];
+        trigramCounts[from] = 0;
+    }
+
+    void clear()
+    {
+        postings.clear();
+        trigramCounts.clear();
+    }
+
+    // the at most limit modules most similar to the folded key by the trigrams they have in common (the Dice
+    // coefficient, twice the shared trigrams over the trigrams of both), best first and at least minScore
+    std::vector<Match> closest(const std::string_view key, const size_t limit, const double minScore = 0.3) const
+    {
+        std::vector<uint32_t> keyTrigrams = trigrams(key);
+        std::vector<uint32_t> shared(trigramCounts.size(), 0);
+        std::vector<uint32_t> candidates;
+        for (uint32_t trigram : keyTrigrams) {
+            auto entry = postings.find(trigram);
+            if (entry == postings.end()) continue;
+            for (uint32_t id : entry->second) {
+                if (shared[id]++ == 0) candidates.push_back(id);
+            }
+        }
+
+        std::vector<Match> matches;
+        for (uint32_t id : candidates) {
+            double score = 2.0 * shared[id] / (keyTrigrams.size() + trigramCounts[id]);
+            if (score >= minScore) matches.push_back(Match{ id, score });
+        }
+        auto better = [](const Match& a, const Match& b) { return a.score != b.score ? a.score > b.score : a.id < b.id; };
+        if (matches.size() > limit) {
+            std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), better);
+            matches.resize(limit);
+        } else std::sort(matches.begin(), matches.end(), better);
+        return matches;
+    }
+
+private:
+    // the distinct trigrams of the padded key, each packed into the low 3 bytes of an integer
+    static std::vector<uint32_t> trigrams(const std::string_view key)
+    {
+        std::string padded = "  " + std::string(key) + " ";
+        std::vector<uint32_t> result;
+        result.reserve(padded.size() - 2);
+        for (size_t i = 0; i + 3 <= padded.size(); i++) {
+            result.push_back((uint32_t)(unsigned char)padded[i] << 16 | (uint32_t)(unsigned char)padded[i + 1] << 8 | (unsigned char)padded[i + 2]);
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    std::vector<uint32_t> trigramCounts; // distinct trigrams of each module, 0 for ids not in the index
+};
+
+// the modules of a transcript sorted by name, with the GPA totals kept up to date on every change
+// changes are counted by a generation number and every changed module remembers what was last persisted for it,
+// so that saving only writes what actually differs and the menu only reformats the GPA when something changed
+//
+// the modules are stored as parallel arrays (grades, credits, key hashes and the position of each name in one
+// shared name arena, where the display name is followed by its folded key) indexed by a dense module id, with a
+// separate list of the ids in folded key order for iterating
+// lookups by name go through an open addressing hash index from folded key to id, and as removing a module moves the
+// last one into its place instead of shifting the arrays, ids only change for that one module
+class ModuleStore {
+public:
+    struct Counters {
+        uint64_t generation = 0;
+        uint64_t persistedGeneration = 0;
+        uint64_t gpaFormats = 0; // number of times the displayed GPA had to be formatted again
+        uint64_t gpaCacheHits = 0;
+        uint64_t skippedSaves = 0; // saves that were no-ops as nothing had changed
+    };
+
+    // while a bulk load is running new modules are only appended to the name order and it is sorted once at the end,
+    // so that loading or importing n modules in any order does not cost n sorted inserts
+    void beginBulkLoad() { bulkLoading = true; }
+
+    void endBulkLoad()
+    {
+        bulkLoading = false;
+        sortByName();
+    }
+
+    size_t size() const { return grades.size(); }
+    bool empty() const { return grades.empty(); }
+    bool contains(const std::string_view name) const { return indexOf(name) != npos; }
+
+    std::optional<ModuleRecord> find(const std::string_view name) const
+    {
+        size_t id = indexOf(name);
+        if (id == npos) return std::nullopt;
+        return ModuleRecord{ grades[id], credits[id] };
+    }
+
+    // calls fn(name, record) for every module in name order
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (uint32_t id : order) fn(nameAt(id), ModuleRecord{ grades[id], credits[id] });
+    }
+
+    // the modules whose names start with prefix (ignoring case) are next to each other in the name order, so finding,
+    // counting and completing them is a pair of binary searches
+    size_t countWithPrefix(const std::string_view prefix) const
+    {
+        std::pair<size_t, size_t> range = prefixRange(prefix);
+        return range.second - range.first;
+    }
+
+    // calls fn(name, record) for the first limit modules in name order that start with prefix
+    template <typename Fn>
+    void forEachWithPrefix(const std::string_view prefix, const size_t limit, Fn fn) const
+    {
+        std::pair<size_t, size_t> range = prefixRange(prefix);
+        for (size_t i = range.first; i < range.second && i - range.first < limit; i++) {
+            uint32_t id = order[i];
+            fn(nameAt(id), ModuleRecord{ grades[id], credits[id] });
+        }
+    }
+
+    // prefix extended for as long as all the modules starting with it agree (ignoring case), in the casing of the first
+    std::string completePrefix(const std::string_view prefix) const
+    {
+        std::pair<size_t, size_t> range = prefixRange(prefix);
+        if (range.first == range.second) return std::string(prefix);
+        // the keys are sorted, so what the first and last have in common all of them have
+        std::string_view first = keyAt(order[range.first]), last = keyAt(order[range.second - 1]);
+        size_t length = prefix.size();
+        while (length < first.size() && length < last.size() && first[length] == last[length]) length++;
+        return std::string(nameAt(order[range.first]).substr(0, length));
+    }
+
+    // names of the at most limit modules most similar to name, best first, for when name is not found
+    // the trigram index is only built the first time it is needed and is then kept up to date on every change
+    std::vector<std::string> similarNames(const std::string_view name, const size_t limit) const
+    {
+        if (!trigramsIndexed) {
+            for (size_t id = 0; id < size(); id++) trigramIndex.add((uint32_t)id, keyAt(id));
+            trigramsIndexed = true;
+        }
+        std::vector<std::string> similar;
+        for (const TrigramIndex::Match& match : trigramIndex.closest(foldName(name), limit)) similar.emplace_back(nameAt(match.id));
+        return similar;
+    }
+
+    // calls fn(name, record) for count modules from position first in the given order
+    // the grade and credit orders are permutations of the name order that are kept until the modules change
+    template <typename Fn>
+    void forEachSorted(const ModuleSort sort, const size_t first, const size_t count, Fn fn) const
+    {
+        const std::vector<uint32_t>& ids = sortedIds(sort);
+        for (size_t i = first; i < ids.size() && i - first < count; i++) fn(nameAt(ids[i]), ModuleRecord{ grades[ids[i]], credits[ids[i]] });
+    }
+
+    // calls fn(grade, credit) for every module in storage order, for when the order does not matter
+    template <typename Fn>
+    void forEachRecord(Fn fn) const
+    {
+        for (size_t id = 0; id < grades.size(); id++) fn(grades[id], credits[id]);
+    }
+
+    // adds or replaces a module as it is on disk, not counted as a change that has to be saved
+    void load(const std::string_view name, const GradeCode grade, const int credit)
+    {
+        size_t id = indexOf(name);
+        if (id != npos) {
+            updateAggregate(agg, grades[id], credits[id], -1);
+            grades[id] = grade;
+            credits[id] = credit;
+            setDisplayName(id, name);
+        } else insert(name, grade, credit);
+        updateAggregate(agg, grade, credit);
+        counters.generation++;
+    }
+
+    void unload(const std::string_view name)
+    {
+        size_t id = indexOf(name);
+        if (id == npos) return;
+        updateAggregate(agg, grades[id], credits[id], -1);
+        remove(id);
+        counters.generation++;
+    }
+
+    void clear()
+    {
+        names.clear();
+        nameArena.clear();
+        deadNameBytes = 0;
+        grades.clear();
+        credits.clear();
+        hashes.clear();
+        order.clear();
+        std::fill(slots.begin(), slots.end(), emptySlot);
+        trigramIndex.clear();
+        trigramsIndexed = false;
+        baseline.clear();
+        agg = GPAAggregate();
+        counters.generation++;
+    }
+
+    // the name of the module as it is displayed, or an empty view if there is no such module
+    std::string_view displayName(const std::string_view name) const
+    {
+        size_t id = indexOf(name);
+        return id == npos ? std::string_view() : nameAt(id);
+    }
+
+    // adds or updates a module, setting the values (and casing of the name) it already has is not a change
+    void set(const std::string& name, const GradeCode grade, const int credit)
+    {
+        size_t id = indexOf(name);
+        if (id != npos && grades[id] == grade && credits[id] == credit && nameAt(id) == name) return;
+
+        rememberBaseline(name);
+        if (id != npos) {
+            updateAggregate(agg, grades[id], credits[id], -1);
+            grades[id] = grade;
+            credits[id] = credit;
+            setDisplayName(id, name);
+        } else insert(name, grade, credit);
+        updateAggregate(agg, grade, credit);
+        settle(name);
+        counters.generation++;
+    }
+
+    bool erase(const std::string& name)
+    {
+        size_t id = indexOf(name);
+        if (id == npos) return false;
+        rememberBaseline(name);
+        updateAggregate(agg, grades[id], credits[id], -1);
+        remove(id);
+        settle(name);
+        counters.generation++;
+        return true;
+    }
+
+    // renaming to the same name in another casing only changes the display name
+    bool rename(const std::string& oldName, const std::string& newName)
+    {
+        size_t id = indexOf(oldName);
+        size_t other = indexOf(newName);
+        if (id == npos || (other != npos && other != id)) return false;
+        rememberBaseline(oldName);
+        rememberBaseline(newName);
+        if (other == id) setDisplayName(id, newName);
+        else {
+            GradeCode grade = grades[id];
+            int credit = credits[id];
+            remove(id);
+            insert(newName, grade, credit);
+        }
+        // a change of casing shares one baseline entry between the two names, which the first settle may already erase
+        settle(oldName);
+        if (other != id) settle(newName);
+        counters.generation++;
+        return true;
+    }
+
+    const GPAAggregate& totals() const { return agg; }
+
+    // the menu's GPA, only formatted again if the modules changed since the last call
+    const std::string& formattedGPA() const
+    {
+        if (formattedGeneration != counters.generation || counters.gpaFormats == 0) {
+            formatted = formatGPA(agg);
+            formattedGeneration = counters.generation;
+            counters.gpaFormats++;
+        } else counters.gpaCacheHits++;
+        return formatted;
+    }
+
+    // names of the modules that differ from what was last persisted, including removed ones
+    std::vector<std::string> dirtyModules() const
+    {
+        std::vector<std::string> dirtyNames;
+        dirtyNames.reserve(baseline.size());
+        for (const auto& entry : baseline) {
+            std::string_view name = displayName(entry.first);
+            if (name.empty()) name = entry.second ? entry.second->name : entry.first;
+            dirtyNames.emplace_back(name);
+        }
+        return dirtyNames;
+    }
+
+    size_t dirtyCount() const { return baseline.size(); }
+    bool isDirty(const std::string_view name) const { return baseline.find(name) != baseline.end(); }
+
+    void markPersisted()
+    {
+        baseline.clear();
+        counters.persistedGeneration = counters.generation;
+    }
+
+    void markSaveSkipped() { counters.skippedSaves++; }
+
+    const Counters& getCounters() const { return counters; }
+
+private:
+    struct NameRef {
+        uint32_t offset;
+        uint32_t length; // of the display name, the folded key of the same length follows it
+    };
+
+    // what a changed module was when it was last persisted
+    struct PersistedModule {
+        std::string name;
+        ModuleRecord record;
+
+        bool operator==(const PersistedModule& other) const { return name == other.name && record == other.record; }
+    };
+
+    static constexpr size_t npos = (size_t)-1;
+    static constexpr uint32_t emptySlot = 0xFFFFFFFFu;
+
+    std::string_view nameAt(const size_t id) const { return std::string_view(nameArena.data() + names[id].offset, names[id].length); }
+    std::string_view keyAt(const size_t id) const { return std::string_view(nameArena.data() + names[id].offset + names[id].length, names[id].length); }
+
+    // a name with the same folded key has the same length, so the new casing is written over the old one
+    void setDisplayName(const size_t id, const std::string_view name)
+    {
+        std::copy(name.begin(), name.end(), nameArena.begin() + names[id].offset);
+    }
+
+    // position in the key order where the name is or would be inserted
+    size_t lowerBound(const std::string_view name) const
+    {
+        size_t low = 0, high = order.size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (FoldedLess()(keyAt(order[mid]), name)) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    const std::vector<uint32_t>& sortedIds(const ModuleSort sort) const
+    {
+        if (sort == SORT_BY_NAME) return order;
+        SortCache& cache = sortCaches[sort == SORT_BY_GRADE ? 0 : 1];
+        if (cache.generation != counters.generation || cache.ids.size() != order.size()) {
+            cache.ids = order;
+            if (sort == SORT_BY_GRADE) {
+                std::stable_sort(cache.ids.begin(), cache.ids.end(), [this](uint32_t a, uint32_t b) { return grades[a] < grades[b]; });
+            } else {
+                std::stable_sort(cache.ids.begin(), cache.ids.end(), [this](uint32_t a, uint32_t b) { return credits[a] > credits[b]; });
+            }
+            cache.generation = counters.generation;
+        }
+        return cache.ids;
+    }
+
+    // positions [first, last) in the name order of the modules that start with prefix
+    std::pair<size_t, size_t> prefixRange(const std::string_view prefix) const
+    {
+        size_t first = lowerBound(prefix);
+        size_t low = first, high = order.size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (foldedStartsWith(keyAt(order[mid]), prefix)) low = mid + 1;
+            else high = mid;
+        }
+        return { first, low };
+    }
+
+    size_t orderPosition(const size_t id) const
+    {
+        if (bulkLoading) return std::find(order.begin(), order.end(), (uint32_t)id) - order.begin();
+        return lowerBound(keyAt(id));
+    }
+
+    // the slot holding the module's id, or the empty slot where it would go
+    size_t findSlot(const std::string_view name, const uint32_t hash) const
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            uint32_t id = slots[slot];
+            if (id == emptySlot || (hashes[id] == hash && foldedEquals(keyAt(id), name))) return slot;
+        }
+    }
+
+    size_t indexOf(const std::string_view name) const
+    {
+        if (slots.empty()) return npos;
+        uint32_t id = slots[findSlot(name, FoldedHash()(name))];
+        return id == emptySlot ? npos : id;
+    }
+
+    // rebuilds the index with room for at least twice the number of modules, keeping the load factor at or below 1/2
+    void rebuildIndex(const size_t capacity)
+    {
+        size_t slotCount = 16;
+        while (slotCount < capacity * 2) slotCount *= 2;
+        slots.assign(slotCount, emptySlot);
+        for (size_t id = 0; id < hashes.size(); id++) {
+            size_t slot = hashes[id] & (slotCount - 1);
+            while (slots[slot] != emptySlot) slot = (slot + 1) & (slotCount - 1);
+            slots[slot] = (uint32_t)id;
+        }
+    }
+
+    void insert(const std::string_view name, const GradeCode grade, const int credit)
+    {
+        uint32_t hash = FoldedHash()(name);
+        if ((size() + 1) * 2 > slots.size()) rebuildIndex(size() + 1);
+        uint32_t id = (uint32_t)size();
+        slots[findSlot(name, hash)] = id;
+        if (bulkLoading) order.push_back(id);
+        else order.insert(order.begin() + lowerBound(name), id);
+
+        names.push_back(NameRef{ (uint32_t)nameArena.size(), (uint32_t)name.size() });
+        nameArena.append(name.data(), name.size());
+        nameArena.append(name.data(), name.size());
+        asciiLowercase(&nameArena[nameArena.size() - name.size()], name.size());
+        grades.push_back(grade);
+        credits.push_back(credit);
+        hashes.push_back(hash);
+        if (trigramsIndexed) trigramIndex.add(id, keyAt(id));
+    }
+
+    void remove(const size_t id)
+    {
+        order.erase(order.begin() + orderPosition(id));
+
+        // backward shift deletion, so that no tombstones are needed
+        size_t mask = slots.size() - 1;
+        size_t hole = findSlot(keyAt(id), hashes[id]);
+        for (size_t next = (hole + 1) & mask; slots[next] != emptySlot; next = (next + 1) & mask) {
+            size_t home = hashes[slots[next]] & mask;
+            // move the entry back if its home slot is not between the hole and its current slot
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = emptySlot;
+        deadNameBytes += names[id].length * 2;
+        if (trigramsIndexed) trigramIndex.remove((uint32_t)id, keyAt(id));
+
+        // the last module takes over the removed id
+        size_t last = size() - 1;
+        if (id != last) {
+            slots[findSlot(keyAt(last), hashes[last])] = (uint32_t)id;
+            order[orderPosition(last)] = (uint32_t)id;
+            if (trigramsIndexed) trigramIndex.renumber((uint32_t)last, (uint32_t)id, keyAt(last));
+            names[id] = names[last];
+            grades[id] = grades[last];
+            credits[id] = credits[last];
+            hashes[id] = hashes[last];
+        }
+        names.pop_back();
+        grades.pop_back();
+        credits.pop_back();
+        hashes.pop_back();
+        if (deadNameBytes > 4096 && deadNameBytes > nameArena.size() / 2) compactNames();
+    }
+
+    // sorts the key order and renumbers the modules to match it, so that iterating in name order is a linear scan again
+    void sortByName()
+    {
+        auto byName = [this](uint32_t a, uint32_t b) { return keyAt(a) < keyAt(b); };
+        if (!std::is_sorted(order.begin(), order.end(), byName)) std::sort(order.begin(), order.end(), byName);
+
+        bool renumber = false;
+        for (size_t i = 0; i < order.size() && !renumber; i++) renumber = order[i] != i;
+        if (!renumber) return;
+
+        std::vector<NameRef> sortedNames(size());
+        std::vector<GradeCode> sortedGrades(size());
+        std::vector<int> sortedCredits(size());
+        std::vector<uint32_t> sortedHashes(size());
+        for (size_t i = 0; i < order.size(); i++) {
+            sortedNames[i] = names[order[i]];
+            sortedGrades[i] = grades[order[i]];
+            sortedCredits[i] = credits[order[i]];
+            sortedHashes[i] = hashes[order[i]];
+            order[i] = (uint32_t)i;
+        }
+        names.swap(sortedNames);
+        grades.swap(sortedGrades);
+        credits.swap(sortedCredits);
+        hashes.swap(sortedHashes);
+        rebuildIndex(size());
+        // every id may have changed, so the trigram index and the sorted orders are built again when next needed
+        trigramIndex.clear();
+        trigramsIndexed = false;
+        for (SortCache& cache : sortCaches) cache.ids.clear();
+    }
+
+    // drops the names of removed modules from the arena
+    void compactNames()
+    {
+        std::string compacted;
+        compacted.reserve(nameArena.size() - deadNameBytes);
+        for (NameRef& ref : names) {
+            uint32_t offset = (uint32_t)compacted.size();
+            compacted.append(nameArena, ref.offset, ref.length * 2);
+            ref.offset = offset;
+        }
+        nameArena.swap(compacted);
+        deadNameBytes = 0;
+    }
+
+    std::optional<PersistedModule> current(const std::string_view name) const
+    {
+        size_t id = indexOf(name);
+        if (id == npos) return std::nullopt;
+        return PersistedModule{ std::string(nameAt(id)), ModuleRecord{ grades[id], credits[id] } };
+    }
+
+    void rememberBaseline(const std::string& name)
+    {
+        if (baseline.find(name) != baseline.end()) return;
+        baseline.emplace(name, current(name));
+    }
+
+    // a module that is back to its persisted values and casing is no longer dirty
+    void settle(const std::string& name)
+    {
+        auto entry = baseline.find(name);
+        if (entry != baseline.end() && entry->second == current(name)) baseline.erase(entry);
+    }
+
+    std::vector<NameRef> names;
+    std::string nameArena;
+    size_t deadNameBytes = 0;
+    std::vector<GradeCode> grades;
+    std::vector<int> credits;
+    std::vector<uint32_t> hashes; // hash of each folded key, so that the index never has to hash a stored name again
+    std::vector<uint32_t> order; // module ids in folded key order
+    std::vector<uint32_t> slots; // hash index from folded key to module id, emptySlot if unused
+    mutable TrigramIndex trigramIndex;
+    mutable bool trigramsIndexed = false;
+    struct SortCache {
+        std::vector<uint32_t> ids;
+        uint64_t generation = 0;
+    };
+    mutable SortCache sortCaches[2]; // by grade and by credit
+    bool bulkLoading = false;
+    std::map<std::string, std::optional<PersistedModule>, FoldedLess> baseline; // persisted values of the changed modules, nullopt if it did not exist
+    GPAAggregate agg;
+    mutable Counters counters;
+    mutable std::string formatted;
+    mutable uint64_t formattedGeneration = 0;
+};
+
+// an immutable copy of the modules for readers on other threads
+// only the store's uncached lookups (find, contains, displayName, forEach, forEachRecord, forEachWithPrefix, totals)
+// are safe to use from several threads at once, so the GPA is formatted ahead of time instead of through formattedGPA
+// and the grade and credit orders are sorted by the first reader that needs them before anyone lists in those orders
+struct ModuleSnapshot {
+    ModuleStore modules;
+    std::string gpa;
+    uint64_t version = 0;
+
+    // after this, forEachSorted only reads the cached orders and is safe to call from several threads
+    void prepareSorts() const
+    {
+        std::call_once(sortsPrepared, [this] {
+            auto ignore = [](std::string_view, const ModuleRecord&) {};
+            modules.forEachSorted(SORT_BY_GRADE, 0, 0, ignore);
+            modules.forEachSorted(SORT_BY_CREDIT, 0, 0, ignore);
+        });
+    }
+
+    mutable std::once_flag sortsPrepared;
+};
+
+// RCU-style publication of the modules: the single writer copies the store into a new snapshot and swaps it in
+// atomically, while readers hold on to whichever snapshot was current when they looked and so never wait for the
+// writer, its changes or the persistence behind them, an old snapshot is freed when the last reader lets go of it
+class SnapshotPublisher {
+public:
+    // writer only
+    void publish(const ModuleStore& gpaMap)
+    {
+        auto next = std::make_shared<ModuleSnapshot>();
+        next->modules = gpaMap;
+        next->gpa = formatGPA(gpaMap.totals());
+        next->version = ++publishedVersion;
+        std::atomic_store_explicit(&current, std::shared_ptr<const ModuleSnapshot>(std::move(next)), std::memory_order_release);
+    }
+
+    std::shared_ptr<const ModuleSnapshot> acquire() const { return std::atomic_load_explicit(&current, std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<const ModuleSnapshot> current;
+    uint64_t publishedVersion = 0; // only touched by the writer
+};
+
+bool checkIfUppercase(const std::string_view input)
+{
+    return isAsciiUppercase(input);
+}
+
+void uppercaseInput(std::string& s)
+{
+    asciiUppercase(s.data(), s.size());
+}
+
+bool checkIfInputIsInt(const std::string_view s)
+{
+    return !s.empty() && isAsciiDigits(s);
+}
+
+// parses a whole decimal number of at most max, for the numeric command line options
+bool parseCount(const std::string_view s, const size_t max, size_t& value)
+{
+    size_t parsed = 0;
+    auto result = std::from_chars(s.data(), s.data() + s.size(), parsed);
+    if (s.empty() || result.ec != std::errc() || result.ptr != s.data() + s.size() || parsed > max) return false;
+    value = parsed;
+    return true;
+}
+
+bool checkIfInputIsAlphabets(const std::string_view s)
+{
+    return isAsciiAlphabets(s);
+}
+
+void pEnd(int numOfTimes = 1) 
+{ 
+    for (int i = 0; i < numOfTimes; i++) { 
+        std::cout << "\n"; 
+    }
+}
+
+void shutdown() 
+{ 
+    pEnd();
+    std::cout << "Thank you for using GPA Calculator v" << version;
+    pEnd();
+    std::cout << "Please press ENTER to continue..."; 
+    std::cin.get();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    for (int i = 3; i >= 0; i--) { 
+        std::cout << "Automatically shutting down in " << i << " seconds...";
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (i != 0) std::cout << "\r";
+    }
+}
+
+bool checkIfFileExist (const std::string& fileName) 
+{
+    struct stat buffer;   
+    return (stat(fileName.c_str(), &buffer) == 0); 
+}
+
+#ifndef _WIN32
+bool writeAll(const int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// makes a rename or a newly created file in the directory durable
+void syncDirectoryOf(const std::string& fileName)
+{
+    std::string dir = std::filesystem::path(fileName).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    ::close(fd);
+}
+#endif
+
+// writes to a temporary file, fsyncs it and renames it over fileName, so a crash leaves either the old or the new content
+bool writeFileAtomically(const std::string& fileName, const std::string& content)
+{
+    std::string tempFile = fileName + ".tmp";
+#ifndef _WIN32
+    int fd = ::open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool written = writeAll(fd, content.data(), content.size()) && fsync(fd) == 0;
+    ::close(fd);
+    if (!written || ::rename(tempFile.c_str(), fileName.c_str()) != 0) {
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    syncDirectoryOf(fileName);
+    return true;
+#else
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    out << content;
+    out.close();
+    std::error_code ec;
+    if (out.fail()) return false;
+    std::filesystem::rename(tempFile, fileName, ec);
+    return !ec;
+#endif
+}
+
+// the gpa.json a gpa.bin was written from, an older copy restored with its timestamps (cp -p) does not match it
+struct SourceStamp {
+    uint64_t size;
+    int64_t mtimeSeconds;
+    int64_t mtimeNanoseconds;
+};
+
+bool statSource(const std::string& fileName, SourceStamp& stamp)
+{
+    struct stat info;
+    if (stat(fileName.c_str(), &info) != 0) return false;
+    stamp.size = (uint64_t)info.st_size;
+    stamp.mtimeSeconds = (int64_t)info.st_mtime;
+#if defined(__APPLE__)
+    stamp.mtimeNanoseconds = (int64_t)info.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    stamp.mtimeNanoseconds = 0;
+#else
+    stamp.mtimeNanoseconds = (int64_t)info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool sameSource(const SourceStamp& a, const SourceStamp& b)
+{
+    return a.size == b.size && a.mtimeSeconds == b.mtimeSeconds && a.mtimeNanoseconds == b.mtimeNanoseconds;
+}
+
+// gpa.bin layout (native byte order): header, string table with all the module names, then one record per module
+struct BinaryHeader {
+    char magic[4];
+    uint32_t formatVersion;
+    uint32_t moduleCount;
+    uint32_t stringTableSize;
+    SourceStamp source; // all zero in a snapshot that has no gpa.json next to it
+};
+
+struct BinaryRecord {
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    uint8_t gradeCode;
+    uint8_t credit;
 };
 
-bool checkIfUppercase(std::string& input)
+static_assert(sizeof(BinaryHeader) == 40 && sizeof(BinaryRecord) == 8, "gpa.bin structs must not be padded");
+const char binaryMagic[4] = { 'G', 'P', 'A', 'B' };
+const uint32_t binaryFormatVersion = 2;
+
+// returns false without writing anything if a module cannot be represented in the binary format
+bool saveBinarySnapshot(const ModuleStore& gpaMap, const std::string& fileName, const SourceStamp& source)
+{
+    std::string names;
+    std::vector<BinaryRecord> records;
+    records.reserve(gpaMap.size());
+    bool representable = true;
+    gpaMap.forEach([&](std::string_view moduleName, const ModuleRecord& module) {
+        if (module.grade == GradeCode::INVALID || module.credit < 0 || module.credit > 255 || moduleName.size() > 0xFFFF) {
+            representable = false;
+            return;
+        }
+
+        BinaryRecord record;
+        record.nameOffset = (uint32_t)names.size();
+        record.nameLength = (uint16_t)moduleName.size();
+        record.gradeCode = (uint8_t)module.grade;
+        record.credit = (uint8_t)module.credit;
+        records.push_back(record);
+        names += moduleName;
+    });
+    if (!representable || names.size() > 0xFFFFFFFFu) return false;
+
+    BinaryHeader header;
+    std::copy(binaryMagic, binaryMagic + 4, header.magic);
+    header.formatVersion = binaryFormatVersion;
+    header.moduleCount = (uint32_t)records.size();
+    header.stringTableSize = (uint32_t)names.size();
+    header.source = source;
+
+    std::string content(reinterpret_cast<const char*>(&header), sizeof(header));
+    content += names;
+    content.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(BinaryRecord));
+    return writeFileAtomically(fileName, content);
+}
+
+bool parseGPABinary(const char* data, const size_t size, ModuleStore& gpaMap)
 {
-    for (auto &c : input) {
-        if (!isupper(c)) return false;
+    BinaryHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (!std::equal(binaryMagic, binaryMagic + 4, header.magic) || header.formatVersion != binaryFormatVersion) return false;
+
+    if ((size - sizeof(header)) < header.stringTableSize) return false;
+    if (size - sizeof(header) - header.stringTableSize != (size_t)header.moduleCount * sizeof(BinaryRecord)) return false;
+    const char* names = data + sizeof(header);
+    const char* records = names + header.stringTableSize;
+
+    for (uint32_t i = 0; i < header.moduleCount; i++) {
+        BinaryRecord record;
+        std::memcpy(&record, records + i * sizeof(BinaryRecord), sizeof(record));
+        if ((size_t)record.nameOffset + record.nameLength > header.stringTableSize || record.gradeCode >= gradeCount) return false;
+        gpaMap.load(std::string(names + record.nameOffset, record.nameLength), (GradeCode)record.gradeCode, (int)record.credit);
     }
     return true;
 }
 
-void uppercaseInput(std::string& s)
+// returns false if gpa.json could not be written, it is then left as it was
+bool saveToPC(const ModuleStore& oldGPAMap)
+{   
+    Json::Value newGPAMap;
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "    ";
+    newGPAMap["gpa"] = Json::Value(Json::objectValue); // keeps an empty transcript loadable
+
+    oldGPAMap.forEach([&newGPAMap](std::string_view f, const ModuleRecord& s) {
+        Json::Value& module = newGPAMap["gpa"][std::string(f)];
+        module["grade"] = gradeName(s.grade);
+        module["credit"] = s.credit;
+    });
+
+    if (!writeFileAtomically(jsonFile, Json::writeString(builder, newGPAMap))) return false;
+
+    // a stale gpa.bin must not shadow the gpa.json that was just written
+    SourceStamp source;
+    if (binarySnapshot && (!statSource(jsonFile, source) || !saveBinarySnapshot(oldGPAMap, binaryFile, source))) {
+        std::remove(binaryFile.c_str());
+    }
+    return true;
+}
+
+// a single compact journal line, "set" for an added/edited module and "del" for a removed one
+std::string journalRecord(const std::string& op, const std::string& moduleName, const GradeCode grade = GradeCode::INVALID, const int credit = 0)
 {
-    int i = 0;
-    for (auto &c : s) {
-        s[i] = toupper(c);
-        i++;
+    Json::Value record;
+    record["op"] = op;
+    record["name"] = moduleName;
+    if (op == "set") {
+        record["grade"] = gradeName(grade);
+        record["credit"] = credit;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, record) + "\n";
+}
+
+// appends and fsyncs the records, the persister calls this once per group commit window at most
+// returns false if the records may not have reached the disk
+bool appendToJournal(const std::string& records, const int count)
+{
+#ifndef _WIN32
+    bool created = !checkIfFileExist(journalFile);
+    int fd = ::open(journalFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    bool written = writeAll(fd, records.data(), records.size()) && fsync(fd) == 0;
+    ::close(fd);
+    if (!written) return false;
+    if (created) syncDirectoryOf(journalFile);
+#else
+    std::ofstream out(journalFile, std::ios::app);
+    out << records;
+    out.close();
+    if (out.fail()) return false;
+#endif
+    journalEntries += count;
+    return true;
+}
+
+// writes the full snapshot to gpa.json and starts a new empty journal
+// a crash in between only means that the journal is replayed over a snapshot that already contains it
+// the journal is left alone if gpa.json could not be written
+bool compactJournal(const ModuleStore& gpaMap)
+{
+    if (!saveToPC(gpaMap)) return false;
+#ifndef _WIN32
+    int fd = ::open(journalFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
     }
+#else
+    std::ofstream out(journalFile, std::ios::trunc);
+    out.close();
+#endif
+    journalEntries = 0;
+    return true;
 }
 
-void titleInput(std::string& s)
+// applies the journal records on top of the loaded gpa.json data, a torn or malformed record is skipped
+int replayJournal(ModuleStore& gpaMap)
 {
-    int toUpper = 1; int i = 0;
-    for (auto &c : s) {
-        if (toUpper) {
-            s[i] = toupper(c);
-            toUpper = 0;
-        } else if(isspace(s[i])) {
-            toUpper = 1;
+    std::ifstream file(journalFile);
+    std::string line;
+    int applied = 0;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        Json::Reader reader;
+        Json::Value record;
+        if (!reader.parse(line, record, false) || !record.isObject()) continue;
+        // malformed records are skipped, asString/asInt would throw on a value of the wrong type
+        if (!record["op"].isString() || !record["name"].isString() || record["name"].asString().empty()) continue;
+
+        std::string op = record["op"].asString();
+        std::string moduleName = record["name"].asString();
+        if (op == "set") {
+            if (!record["grade"].isString() || !record["credit"].isInt()) continue;
+            GradeCode grade = internGrade(record["grade"].asString());
+            int credit = record["credit"].asInt();
+            if (grade == GradeCode::INVALID || credit < 0 || credit > 99) continue;
+            gpaMap.load(moduleName, grade, credit);
+        } else if (op == "del") {
+            gpaMap.unload(moduleName);
+        } else continue;
+        applied++;
+    }
+    file.close();
+    journalEntries = applied;
+    return applied;
+}
+
+// bounded lock-free queue for exactly one producer thread and one consumer thread
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool push(T&& value)
+    {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity) return false;
+        slots[tail & (Capacity - 1)] = std::move(value);
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[head & (Capacity - 1)]);
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return headIndex.load(std::memory_order_acquire) == tailIndex.load(std::memory_order_acquire); }
+    bool full() const { return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire) == Capacity; }
+
+private:
+    std::array<T, Capacity> slots;
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+};
+
+// a single module change, or a full copy of the modules for bulk changes such as imports
+struct PersistDelta {
+    uint64_t version = 0;
+    std::string moduleName;
+    bool removed = false;
+    GradeCode grade = GradeCode::INVALID;
+    int credit = 0;
+    std::shared_ptr<const ModuleStore> snapshot;
+};
+
+// write-behind persistence, the input loop only queues deltas and a background thread keeps its own copy
+// of the modules up to date and writes each burst of changes with a single journal append (or gpa.json rewrite)
+class Persister {
+public:
+    ~Persister() { stop(); }
+
+    void start(const ModuleStore& gpaMap)
+    {
+        if (running.load()) return;
+        mirror = gpaMap;
+        running.store(true);
+        worker = std::thread([this] { loop(); });
+    }
+
+    void submitChange(const ModuleStore& gpaMap, const std::string& moduleName)
+    {
+        PersistDelta delta;
+        delta.moduleName = moduleName;
+        std::optional<ModuleRecord> record = gpaMap.find(moduleName);
+        if (record) {
+            delta.grade = record->grade;
+            delta.credit = record->credit;
+        } else delta.removed = true;
+        submit(std::move(delta));
+    }
+
+    void submitSnapshot(const ModuleStore& gpaMap)
+    {
+        PersistDelta delta;
+        delta.snapshot = std::make_shared<const ModuleStore>(gpaMap);
+        submit(std::move(delta));
+    }
+
+    // blocks until everything submitted so far has been written, false if writing it failed
+    bool flush()
+    {
+        uint64_t target = submittedVersion;
+        if (running.load()) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            durableChanged.wait(lock, [this, target] {
+                return durable.load(std::memory_order_acquire) >= target || failed.load(std::memory_order_acquire) >= target;
+            });
+        }
+        return durable.load(std::memory_order_acquire) >= target;
+    }
+
+    // flushes, folds the journal back into gpa.json and stops the background thread
+    // returns false if some of the changes could not be saved
+    bool stop()
+    {
+        if (!running.load()) return unsavedVersion == 0;
+        flush();
+        running.store(false);
+        wakeConsumer();
+        worker.join();
+        if (journalMode && journalEntries > 0 && unsavedVersion == 0 && !compactJournal(mirror)) {
+            std::cerr << "\nError: " << jsonFile << " could not be updated, the changes are kept in " << journalFile << "\n";
+        }
+        return unsavedVersion == 0;
+    }
+
+    uint64_t durableVersion() const { return durable.load(std::memory_order_acquire); }
+
+private:
+    void submit(PersistDelta&& delta)
+    {
+        delta.version = ++submittedVersion;
+        if (!running.load()) {
+            // nothing to hand it to, e.g. after a fatal error stopped the thread
+            apply(delta);
+            commit({ delta });
+            return;
+        }
+        while (!queue.push(std::move(delta))) waitForRoom();
+        // the push stays lock-free, the mutex is only taken when the background thread is parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerParked.load(std::memory_order_relaxed)) wakeConsumer();
+    }
+
+    // a full queue wakes the background thread, even in the middle of a group commit window, and waits for its next drain
+    void waitForRoom()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        producerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        queueChanged.notify_one();
+        queueDrained.wait(lock, [this] { return !queue.full(); });
+        producerWaiting.store(false, std::memory_order_relaxed);
+    }
+
+    void wakeConsumer()
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        queueChanged.notify_one();
+    }
+
+    // parks the background thread until something is pushed or the persister is stopped
+    void waitForWork()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        consumerParked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        queueChanged.wait(lock, [this] { return !queue.empty() || !running.load(); });
+        consumerParked.store(false, std::memory_order_relaxed);
+    }
+
+    void apply(const PersistDelta& delta)
+    {
+        if (delta.snapshot) mirror = *delta.snapshot;
+        else if (delta.removed) mirror.unload(delta.moduleName);
+        else mirror.load(delta.moduleName, delta.grade, delta.credit);
+    }
+
+    // a full write replaces gpa.json with the mirror instead of appending the batch to the journal
+    bool write(const std::vector<PersistDelta>& batch, bool full)
+    {
+        for (const auto& delta : batch) full = full || delta.snapshot != nullptr;
+        if (!journalMode) return saveToPC(mirror);
+        if (full) return compactJournal(mirror);
+
+        std::string records;
+        for (const auto& delta : batch) {
+            if (delta.removed) records += journalRecord("del", delta.moduleName);
+            else records += journalRecord("set", delta.moduleName, delta.grade, delta.credit);
+        }
+        if (!appendToJournal(records, (int)batch.size())) return false;
+        // the journal already holds every record, a failed compaction is retried with the next one
+        if (journalEntries >= journalCompactThreshold) compactJournal(mirror);
+        return true;
+    }
+
+    // writes the batch and advances the durable version only if that succeeded
+    // after a failure the next commit writes the whole mirror, as the journal may be missing records
+    void commit(const std::vector<PersistDelta>& batch)
+    {
+        uint64_t version = batch.empty() ? unsavedVersion : batch.back().version;
+        if (write(batch, unsavedVersion != 0)) {
+            unsavedVersion = 0;
+            durable.store(version, std::memory_order_release);
         } else {
-            s[i] = tolower(c);
+            unsavedVersion = version;
+            failed.store(version, std::memory_order_release);
+            std::cerr << "\nError: the changes could not be saved, writing them is tried again with the next change\n";
         }
-        i++;
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        durableChanged.notify_all();
+    }
+
+    // empties the queue into the batch and wakes the producer if it was waiting for room
+    void drain(std::vector<PersistDelta>& batch)
+    {
+        PersistDelta delta;
+        size_t drained = batch.size();
+        while (queue.pop(delta)) {
+            apply(delta);
+            batch.push_back(std::move(delta));
+        }
+        if (batch.size() == drained) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            queueDrained.notify_one();
+        }
+    }
+
+    void loop()
+    {
+        std::vector<PersistDelta> batch;
+        auto lastCommit = std::chrono::steady_clock::now() - groupCommitWindow;
+        while (true) {
+            batch.clear();
+            drain(batch);
+            if (batch.empty()) {
+                if (running.load()) {
+                    waitForWork();
+                    continue;
+                }
+                // stopping, changes that failed to be written get one last attempt
+                if (unsavedVersion == 0) break;
+                commit(batch);
+                break;
+            }
+
+            // group commit, everything that arrives within the window shares one write and one fsync
+            // the queue is drained whenever it fills up in the meantime, so that the producer never waits for the window
+            auto commitAt = lastCommit + groupCommitWindow;
+            while (std::chrono::steady_clock::now() < commitAt) {
+                {
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    queueChanged.wait_until(lock, commitAt, [this] { return queue.full() || !running.load(); });
+                }
+                drain(batch);
+                if (!running.load()) break;
+            }
+            drain(batch);
+            commit(batch);
+            lastCommit = std::chrono::steady_clock::now();
+        }
+    }
+
+    SPSCQueue<PersistDelta, 1024> queue;
+    ModuleStore mirror; // only touched by the background thread while it is running
+    std::thread worker;
+    std::atomic<bool> running{false};
+    uint64_t submittedVersion = 0; // only touched by the producer
+    std::atomic<uint64_t> durable{0};
+    std::atomic<uint64_t> failed{0}; // the last version that could not be written
+    uint64_t unsavedVersion = 0; // set while a failed write has not been retried successfully, owned like mirror
+    std::mutex wakeMutex;
+    std::condition_variable queueChanged; // the background thread waits on this while the queue is empty or in a window
+    std::condition_variable queueDrained; // the producer waits on this while the queue is full
+    std::condition_variable durableChanged; // flush waits on this
+    std::atomic<bool> consumerParked{false};
+    std::atomic<bool> producerWaiting{false};
+};
+
+Persister persister;
+
+// persists the modules that changed since the last save in the background, a no-op if nothing changed
+void saveChanges(ModuleStore& gpaMap)
+{
+    if (gpaMap.dirtyCount() == 0) {
+        gpaMap.markSaveSkipped();
+        return;
+    }
+    if (gpaMap.dirtyCount() > (size_t)journalCompactThreshold) {
+        gpaMap.markPersisted();
+        persister.submitSnapshot(gpaMap);
+        return;
     }
+    for (const std::string& moduleName : gpaMap.dirtyModules()) persister.submitChange(gpaMap, moduleName);
+    gpaMap.markPersisted();
 }
 
-bool checkIfInputIsInt(const std::string& s)
+bool checkIfInputIsValidGrade(std::string& grade)
+{
+    if (!checkIfUppercase(grade)) uppercaseInput(grade);
+    return internGrade(grade) != GradeCode::INVALID;
+}
+
+void printMenu(const std::string& gpaString, const bool& validJsonFile)
 {
-    for (auto &c : s) {
-        if (!isdigit(c)) return false;
+    static TextBuilder menu; // reused on every redraw
+    menu.clear();
+    menu << "\n\n------------ Menu ------------\n\n";
+    menu << "> Current GPA: " << gpaString << "\n\n";
+
+    menu << "1. Add new module results\n";
+    if (validJsonFile) {
+        menu << "2. Edit module results\n";
+        menu << "3. Remove module results\n";
+        menu << "4. View all module results\n";
     }
-    return true;
+    menu << "5. Import module results from a CSV/TSV file\n";
+    menu << "F. Shutdown\n";
+    menu << "\n-------------------------------";
+    std::cout << menu.str();
 }
 
-bool checkIfInputIsAlphabets(const std::string& s)
+void printModule(const std::string_view moduleName, const ModuleRecord& value)
 {
-    for (auto &c : s) {
-        if (!isalpha(c)) return false;
+    std::cout << "- " << moduleName << " (" << value.credit << "): " << gradeName(value.grade) << "\n";
+}
+
+// formats the module listing into one reusable buffer and writes it out in large blocks instead of streaming every
+// field through the stream on its own, the buffer keeps its capacity so that rows are formatted without allocating
+class ModuleListRenderer {
+public:
+    explicit ModuleListRenderer(std::ostream& out) : out(out) { buffer.reserve(flushSize + 256); }
+    ~ModuleListRenderer() { flush(); }
+
+    void text(const std::string_view s)
+    {
+        buffer.append(s.data(), s.size());
+        if (buffer.size() >= flushSize) flush();
+    }
+
+    // "- name (credit): grade"
+    void row(const std::string_view moduleName, const ModuleRecord& value)
+    {
+        char credit[16];
+        char* creditEnd = std::to_chars(credit, credit + sizeof(credit), value.credit).ptr;
+        buffer += "- ";
+        buffer.append(moduleName.data(), moduleName.size());
+        buffer += " (";
+        buffer.append(credit, creditEnd - credit);
+        buffer += "): ";
+        buffer += gradeName(value.grade);
+        buffer += '\n';
+        if (buffer.size() >= flushSize) flush();
+    }
+
+    void flush()
+    {
+        if (buffer.empty()) return;
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        buffer.clear();
     }
+
+private:
+    static constexpr size_t flushSize = 64 * 1024;
+
+    std::ostream& out;
+    std::string buffer;
+};
+
+struct ListOptions {
+    ModuleSort sort = SORT_BY_NAME;
+    size_t limit = 0; // most modules listed, 0 for all of them
+    size_t pageSize = 0; // modules listed before asking to continue, 0 to list them all at once
+};
+
+// set from the command line (--sort, --limit, --page-size) for the module listing
+ListOptions listOptions;
+
+bool parseModuleSort(const std::string_view s, ModuleSort& sort)
+{
+    if (s == "name") sort = SORT_BY_NAME;
+    else if (s == "grade") sort = SORT_BY_GRADE;
+    else if (s == "credit") sort = SORT_BY_CREDIT;
+    else return false;
     return true;
 }
 
-void pEnd(int numOfTimes = 1) 
-{ 
-    for (int i = 0; i < numOfTimes; i++) { 
-        std::cout << "\n"; 
+// writes the module listing to out, asking on in whether to go on after every page
+void renderModuleList(const ModuleStore& gpaMap, const ListOptions& options, std::ostream& out, std::istream& in)
+{
+    size_t total = options.limit ? std::min(options.limit, gpaMap.size()) : gpaMap.size();
+    size_t pageSize = options.pageSize ? options.pageSize : total;
+    ModuleListRenderer renderer(out);
+    for (size_t first = 0; first < total; first += pageSize) {
+        gpaMap.forEachSorted(options.sort, first, std::min(pageSize, total - first), [&renderer](std::string_view moduleName, const ModuleRecord& value) {
+            renderer.row(moduleName, value);
+        });
+        if (first + pageSize >= total) break;
+
+        TextBuilder prompt;
+        prompt << "-- " << first + pageSize << " of " << total << " shown, press ENTER for more or x to stop --";
+        renderer.text(prompt.str());
+        renderer.flush();
+        std::string more;
+        std::getline(in, more);
+        if (more == "x" || more == "X" || !in) break;
+    }
+    if (total < gpaMap.size()) {
+        TextBuilder notListed;
+        notListed << "... " << gpaMap.size() - total << " more not listed\n";
+        renderer.text(notListed.str());
     }
 }
 
-void shutdown() 
-{ 
+void readJsonGPAData(const ModuleStore& gpaMap, const ListOptions& options = listOptions)
+{
     pEnd();
-    std::cout << "Thank you for using GPA Calculator v" << version;
+    std::cout << "----------------------------------------------\n\n";
+    std::cout << "Reading GPA data...\n\n";
+    renderModuleList(gpaMap, options, std::cout, std::cin);
     pEnd();
-    std::cout << "Please press ENTER to continue..."; 
-    std::cin.get();
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    for (int i = 3; i >= 0; i--) { 
-        std::cout << "Automatically shutting down in " << i << " seconds...";
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        if (i != 0) std::cout << "\r";
+    std::cout << "Format:\nModule Name (Max Credits): Your Grade\n";
+    std::cout << "\n----------------------------------------------\n";
+}
+
+// the modules shown at the edit/remove prompts, only how many there are if there are too many to list
+void printModulePromptList(const ModuleStore& gpaMap)
+{
+    if (gpaMap.size() <= promptListLimit) {
+        // always in name order and on one page, the prompt follows right after it
+        readJsonGPAData(gpaMap, ListOptions());
+        return;
+    }
+    pEnd();
+    std::cout << "There are " << gpaMap.size() << " modules, type the start of a module name to list the ones it matches...\n";
+}
+
+// the module picked by what was typed at the edit/remove prompts, either its name in any casing or the start of
+// only one module's name, empty if that did not pick out a single module
+// when the start matches several modules the first few are listed along with how far it can be completed
+std::string resolveModuleName(const ModuleStore& gpaMap, const std::string_view input)
+{
+    std::string_view exactName = gpaMap.displayName(input);
+    if (!exactName.empty()) return std::string(exactName);
+
+    // every module starts with the empty string, a blank answer must not pick one of them
+    size_t matches = input.empty() ? 0 : gpaMap.countWithPrefix(input);
+    if (matches == 0) {
+        std::cout << "Module not found!\n";
+        std::vector<std::string> similar = gpaMap.similarNames(input, suggestionLimit);
+        if (!similar.empty()) {
+            std::cout << "Did you mean ";
+            for (size_t i = 0; i < similar.size(); i++) std::cout << (i == 0 ? "" : i + 1 == similar.size() ? " or " : ", ") << "\"" << similar[i] << "\"";
+            std::cout << "?\n";
+        }
+        return "";
+    }
+    if (matches == 1) {
+        std::string moduleName;
+        gpaMap.forEachWithPrefix(input, 1, [&moduleName](std::string_view name, const ModuleRecord&) { moduleName = name; });
+        return moduleName;
+    }
+
+    std::cout << matches << " modules start with \"" << input << "\":\n";
+    gpaMap.forEachWithPrefix(input, promptListLimit, printModule);
+    if (matches > promptListLimit) std::cout << "... and " << matches - promptListLimit << " more\n";
+    std::string completion = gpaMap.completePrefix(input);
+    if (completion.size() > input.size()) std::cout << "All of them start with \"" << completion << "\"\n";
+    return "";
+}
+
+// full recalculation, the store keeps the same totals up to date on every change
+GPAAggregate calculateGPA(const ModuleStore& gpaMap)
+{
+    GPAAggregate agg;
+    gpaMap.forEachRecord([&agg](GradeCode grade, int credit) {
+        updateAggregate(agg, grade, credit);
+    });
+    return agg;
+}
+
+// compile with -DGPA_DEBUG_AGGREGATE to cross-check the running totals against a full recalculation
+#ifdef GPA_DEBUG_AGGREGATE
+void verifyAggregate(const ModuleStore& gpaMap)
+{
+    const GPAAggregate& agg = gpaMap.totals();
+    GPAAggregate expected = calculateGPA(gpaMap);
+    if (expected.totalCredits != agg.totalCredits || expected.totalPoints != agg.totalPoints) {
+        throw std::logic_error("GPA aggregate mismatch: expected " + formatGPA(expected, 4) + " but got " + formatGPA(agg, 4));
     }
 }
+#endif
+
+// single pass parser for the {"gpa": {name: {"grade": ..., "credit": ...}}} layout of gpa.json
+// that fills the gpaMap directly, anything outside of that layout makes it bail out so that jsoncpp can handle it
+struct GPAJsonParser {
+    const char* pos;
+    const char* end;
+
+    void skipWhitespace()
+    {
+        while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')) pos++;
+    }
+
+    bool consume(const char c)
+    {
+        skipWhitespace();
+        if (pos >= end || *pos != c) return false;
+        pos++;
+        return true;
+    }
+
+    bool parseString(std::string& out)
+    {
+        if (!consume('"')) return false;
+        out.clear();
+        while (pos < end) {
+            const char* start = pos;
+            while (pos < end && *pos != '"' && *pos != '\\' && (unsigned char)*pos >= 0x20) pos++;
+            out.append(start, pos);
+            if (pos >= end || (unsigned char)*pos < 0x20) return false;
+            if (*pos == '"') {
+                pos++;
+                return true;
+            }
+
+            // escape sequences
+            if (++pos >= end) return false;
+            switch (*pos++) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (end - pos < 4) return false;
+                    unsigned int cp = 0;
+                    for (int i = 0; i < 4; i++) {
+                        char h = *pos++;
+                        cp <<= 4;
+                        if (h >= '0' && h <= '9') cp |= h - '0';
+                        else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+                        else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+                        else return false;
+                    }
+                    if (cp >= 0xD800 && cp <= 0xDFFF) return false; // surrogate pairs are left to jsoncpp
+                    if (cp < 0x80) {
+                        out += (char)cp;
+                    } else if (cp < 0x800) {
+                        out += (char)(0xC0 | (cp >> 6));
+                        out += (char)(0x80 | (cp & 0x3F));
+                    } else {
+                        out += (char)(0xE0 | (cp >> 12));
+                        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                        out += (char)(0x80 | (cp & 0x3F));
+                    }
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseInt(int& out)
+    {
+        skipWhitespace();
+        bool negative = false;
+        if (pos < end && *pos == '-') {
+            negative = true;
+            pos++;
+        }
+        if (pos >= end || *pos < '0' || *pos > '9') return false;
+        long long value = 0;
+        while (pos < end && *pos >= '0' && *pos <= '9') {
+            value = value * 10 + (*pos++ - '0');
+            if (value > std::numeric_limits<int>::max()) return false;
+        }
+        // fractions and exponents are left to jsoncpp
+        if (pos < end && (*pos == '.' || *pos == 'e' || *pos == 'E')) return false;
+        out = (int)(negative ? -value : value);
+        return true;
+    }
+
+    bool parseModule(std::string& grade, int& credit)
+    {
+        if (!consume('{')) return false;
+        bool hasGrade = false, hasCredit = false;
+        std::string key;
+        if (consume('}')) return false;
+        do {
+            if (!parseString(key) || !consume(':')) return false;
+            if (key == "grade") {
+                if (!parseString(grade)) return false;
+                hasGrade = true;
+            } else if (key == "credit") {
+                if (!parseInt(credit)) return false;
+                hasCredit = true;
+            } else return false;
+        } while (consume(','));
+        return consume('}') && hasGrade && hasCredit;
+    }
+
+    bool parse(ModuleStore& gpaMap)
+    {
+        std::string key;
+        if (!consume('{') || !parseString(key) || key != "gpa" || !consume(':') || !consume('{')) return false;
+        if (!consume('}')) {
+            std::string moduleName, grade;
+            int credit = 0;
+            do {
+                if (!parseString(moduleName) || !consume(':') || !parseModule(grade, credit)) return false;
+                GradeCode code = internGrade(grade);
+                if (code == GradeCode::INVALID) return false;
+                gpaMap.load(moduleName, code, credit);
+            } while (consume(','));
+            if (!consume('}')) return false;
+        }
+        if (!consume('}')) return false;
+        skipWhitespace();
+        return pos == end;
+    }
+};
+
+// read-only view of a file's bytes, memory-mapped for regular files and read into a buffer for pipes and the like
+class FileView {
+public:
+    FileView() = default;
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+    ~FileView() { release(); }
+
+    bool open(const std::string& fileName)
+    {
+        release();
+#ifndef _WIN32
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, (size_t)info.st_size, MADV_SEQUENTIAL);
+                mapping = mapped;
+                bytes = static_cast<const char*>(mapped);
+                length = (size_t)info.st_size;
+                ::close(fd);
+                return true;
+            }
+        }
+
+        char chunk[65536];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ::close(fd);
+                return false;
+            }
+            buffer.append(chunk, (size_t)n);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file) return false;
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+#endif
+        bytes = buffer.data();
+        length = buffer.size();
+        return true;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    void release()
+    {
+#ifndef _WIN32
+        if (mapping) munmap(mapping, length);
+#endif
+        mapping = nullptr;
+        bytes = nullptr;
+        length = 0;
+        buffer.clear();
+    }
+
+    void* mapping = nullptr;
+    const char* bytes = nullptr;
+    size_t length = 0;
+    std::string buffer;
+};
 
-bool checkIfFileExist (const std::string& fileName) 
+// gpa.bin is only trusted if it was written from the gpa.json that is there now
+bool useBinarySnapshot()
 {
-    struct stat buffer;   
-    return (stat(fileName.c_str(), &buffer) == 0); 
+    SourceStamp current;
+    if (!binarySnapshot || !statSource(jsonFile, current)) return false;
+
+    BinaryHeader header;
+    std::ifstream in(binaryFile, std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (!std::equal(binaryMagic, binaryMagic + 4, header.magic) || header.formatVersion != binaryFormatVersion) return false;
+    return sameSource(header.source, current);
 }
 
-void saveToPC(const gpaHashMapStruc& oldGPAMap)
-{   
-    Json::Value newGPAMap;
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "    ";
+enum LoadStatus { LOAD_OK, LOAD_PARSE_ERROR, LOAD_MISSING_GPA, LOAD_INVALID_GRADE };
 
-    for (auto it = oldGPAMap.begin(); it != oldGPAMap.end(); ++it) {
-        auto f = it->first; auto s = it->second;
-        newGPAMap["gpa"][f]["grade"] = std::get<0>(s);
-        newGPAMap["gpa"][f]["credit"] = std::get<1>(s);
+LoadStatus parseGPAFile(const FileView& file, ModuleStore& gpaMap)
+{
+    if (file.size() >= 4 && std::equal(binaryMagic, binaryMagic + 4, file.data())) {
+        return parseGPABinary(file.data(), file.size(), gpaMap) ? LOAD_OK : LOAD_PARSE_ERROR;
     }
 
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    std::ofstream out(jsonFile);
-    writer->write(newGPAMap, &out);
-    out.close();
-}
+    GPAJsonParser parser = { file.data(), file.data() + file.size() };
+    if (parser.parse(gpaMap)) return LOAD_OK;
 
-float gradeToFloat(std::string& grade) 
-{
-    if (!checkIfUppercase(grade)) uppercaseInput(grade);
-    auto it = gpaRef.find(grade);
-    if (it != gpaRef.end()) return it->second;
-    else return -1.0;
+    // fall back to jsoncpp for anything that the parser above does not expect
+    gpaMap.clear();
+    Json::Reader reader;
+    Json::Value root;
+    if (!reader.parse(file.data(), file.data() + file.size(), root)) return LOAD_PARSE_ERROR;
+    if (!root.isObject() || root["gpa"].isNull()) return LOAD_MISSING_GPA;
+
+    // the types are checked first, jsoncpp throws from asString/asInt on a value of the wrong type
+    const Json::Value& values = root["gpa"];
+    if (!values.isObject()) return LOAD_PARSE_ERROR;
+    for (auto it = values.begin(); it != values.end(); it++) {
+        if (!it->isObject() || !(*it)["credit"].isInt()) {
+            gpaMap.clear();
+            return LOAD_PARSE_ERROR;
+        }
+        GradeCode grade = (*it)["grade"].isString() ? internGrade((*it)["grade"].asString()) : GradeCode::INVALID;
+        if (grade == GradeCode::INVALID) {
+            gpaMap.clear();
+            return LOAD_INVALID_GRADE;
+        }
+        gpaMap.load(it.name(), grade, (*it)["credit"].asInt());
+    }
+    return LOAD_OK;
 }
 
-bool checkIfInputIsValidGrade(std::string& grade)
+LoadStatus loadGPAFile(const std::string& fileName, ModuleStore& gpaMap)
 {
-    if (!checkIfUppercase(grade)) uppercaseInput(grade);
-    auto it = gpaRef.find(grade);
-    if (it != gpaRef.end()) return true;
-    else return false;
+    FileView file;
+    if (!file.open(fileName)) return LOAD_PARSE_ERROR;
+    gpaMap.beginBulkLoad();
+    LoadStatus status = parseGPAFile(file, gpaMap);
+    gpaMap.endBulkLoad();
+    return status;
 }
 
-void printMsgWithNthPrec(const std::vector<std::string>& msgArr, const int prec)
+// splits the next delimited field off the line, quoted fields may contain the delimiter and "" for a quote
+// the returned view points either into the line or, if the field had to be unescaped, into scratch
+std::string_view nextField(std::string_view& line, const char delimiter, std::string& scratch)
 {
-    std::cout << std::fixed << std::showpoint;
-    std::cout << std::setprecision(prec);
-    for (int i = 0; i < msgArr.size(); i++) {
-        try {
-            float num = std::stof(msgArr[i]);
-            std::cout << num;
-        } catch (std::invalid_argument& e) {
-            std::cout << msgArr[i];
+    size_t start = 0;
+    while (start < line.size() && line[start] == ' ') start++;
+    if (start < line.size() && line[start] == '"') {
+        size_t i = start + 1;
+        bool escaped = false;
+        while (i < line.size()) {
+            if (line[i] == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') {
+                    escaped = true;
+                    i += 2;
+                    continue;
+                }
+                break;
+            }
+            i++;
         }
+        std::string_view field = line.substr(start + 1, i - start - 1);
+        size_t next = line.find(delimiter, i);
+        line = next == std::string_view::npos ? std::string_view() : line.substr(next + 1);
+        if (!escaped) return field;
+
+        scratch.clear();
+        for (size_t j = 0; j < field.size(); j++) {
+            scratch += field[j];
+            if (field[j] == '"') j++;
+        }
+        return scratch;
     }
-    pEnd();
+
+    size_t next = line.find(delimiter);
+    std::string_view field = line.substr(0, next);
+    line = next == std::string_view::npos ? std::string_view() : line.substr(next + 1);
+    while (!field.empty() && field.back() == ' ') field.remove_suffix(1);
+    return field.substr(std::min(start, field.size()));
 }
 
-void printMenu(const float& gpa, const bool& validJsonFile)
+// same rules as the credit prompts, a whole number from 0 to 99
+bool checkIfInputIsValidCredit(const std::string_view s, int& credit)
 {
-    std::cout << "\n\n------------ Menu ------------\n\n";
-    std::string gpaString;
-    if (gpa < 0) gpaString = "N/A";
-    else gpaString = std::to_string(gpa);
+    if (s.empty() || s.size() > 2 || !checkIfInputIsInt(s)) return false;
+    credit = s.size() == 1 ? s[0] - '0' : (s[0] - '0') * 10 + (s[1] - '0');
+    return true;
+}
 
-    std::vector<std::string> msgArr = { "> Current GPA: ", gpaString };
-    printMsgWithNthPrec(msgArr, 2);
-    pEnd();
+struct ImportResult {
+    size_t imported = 0;
+    size_t skipped = 0;
+};
 
-    std::cout << "1. Add new module results";
-    if (validJsonFile) {
-        pEnd();
+// imports "name, grade, credit[, term]" rows (comma or tab separated, the term is accepted but not stored)
+// every rejected row is reported to errors with its line number, nothing is saved here
+ImportResult importModules(const char* data, const size_t size, ModuleStore& gpaMap, std::ostream& errors)
+{
+    ImportResult result;
+    gpaMap.beginBulkLoad();
+    std::string_view content(data, size);
+    size_t firstLineEnd = content.find('\n');
+    char delimiter = content.substr(0, firstLineEnd).find('\t') != std::string_view::npos ? '\t' : ',';
 
-        std::cout << "2. Edit module results";
-        pEnd();
+    std::string nameScratch, gradeScratch, creditScratch;
+    size_t lineNumber = 0;
+    while (!content.empty()) {
+        size_t lineEnd = content.find('\n');
+        std::string_view line = content.substr(0, lineEnd);
+        content = lineEnd == std::string_view::npos ? std::string_view() : content.substr(lineEnd + 1);
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
 
-        std::cout << "3. Remove module results";
-        pEnd();
+        std::string_view nameField = nextField(line, delimiter, nameScratch);
+        std::string_view gradeField = nextField(line, delimiter, gradeScratch);
+        std::string_view creditField = nextField(line, delimiter, creditScratch);
+        GradeCode grade = internGrade(gradeField);
+        int credit = 0;
+        bool validCredit = checkIfInputIsValidCredit(creditField, credit);
 
-        std::cout << "4. View all module results";
-    }
-    pEnd();
+        // a first row that is not a valid record is taken to be the header
+        if (lineNumber == 1 && grade == GradeCode::INVALID && !validCredit) continue;
 
-    std::cout << "F. Shutdown";
-    pEnd();
+        std::string moduleName(nameField);
+        std::string reason;
+        if (moduleName.empty()) reason = "module name cannot be empty";
+        else if (grade == GradeCode::INVALID) reason = "invalid grade \"" + std::string(gradeField) + "\"";
+        else if (!validCredit) reason = "invalid credit \"" + std::string(creditField) + "\"";
+        else if (gpaMap.contains(moduleName)) reason = "module " + moduleName + " already exists";
 
-    std::cout << "\n-------------------------------";
-}
+        if (!reason.empty()) {
+            errors << "Line " << lineNumber << ": " << reason << "\n";
+            result.skipped++;
+            continue;
+        }
 
-void readJsonGPAData(const gpaHashMapStruc& gpaMap)
-{
-    pEnd();
-    std::cout << "----------------------------------------------\n\n";
-    std::cout << "Reading GPA data...\n\n";
-    for (auto it = gpaMap.begin(); it != gpaMap.end(); it++) {
-        auto moduleName = it->first; auto value = it->second;
-        std::cout << "- " << moduleName << " (" << std::get<1>(value) << "): " << std::get<0>(value) << "\n";
+        gpaMap.set(moduleName, grade, credit);
+        result.imported++;
     }
-    pEnd();
-    std::cout << "Format:\nModule Name (Max Credits): Your Grade\n";
-    std::cout << "\n----------------------------------------------\n";
+    gpaMap.endBulkLoad();
+    return result;
 }
 
-float calculateGPA(const gpaHashMapStruc& gpaMap)
+// loads gpa.json, or gpa.bin when it is up to date, and replays the journal on top of it
+// the status is that of gpa.json, LOAD_OK if there is none yet
+LoadStatus loadSavedModules(ModuleStore& gpaMap)
 {
-    int totalCredits = 0;
-    int totalGrade = 0;
-    for(gpaHashMapStruc::const_iterator it = gpaMap.begin(); it != gpaMap.end(); it++) {
-        std::string grade = std::get<0>(it->second);
-        if (grade != "P") {
-            int credits = std::get<1>(it->second);
-            totalCredits += credits;
-            totalGrade += gradeToFloat(grade) * credits;
-        }
+    if (!checkIfFileExist(jsonFile)) {
+        if (journalMode && checkIfFileExist(journalFile)) replayJournal(gpaMap);
+        return LOAD_OK;
+    }
+
+    LoadStatus status = useBinarySnapshot() ? loadGPAFile(binaryFile, gpaMap) : LOAD_PARSE_ERROR;
+    if (status != LOAD_OK) {
+        gpaMap.clear();
+        status = loadGPAFile(jsonFile, gpaMap);
     }
-    return totalGrade / (float)totalCredits;
+    // the journal only makes sense on top of the gpa.json it was written against, so with a gpa.json that cannot be
+    // loaded both files are left alone, nothing is replayed and there is nothing for the persister to compact
+    if (status != LOAD_OK) {
+        gpaMap.clear();
+        return status;
+    }
+    if (journalMode && checkIfFileExist(journalFile)) replayJournal(gpaMap);
+    return status;
 }
 
 void mainProcess()
 {
     bool jsonFileExist = checkIfFileExist(jsonFile);
-    bool jsonValid = false;
-    if (jsonFileExist) {
-        std::ifstream file(jsonFile);
-        bool parsed = reader.parse(file, root);
-        file.close();
-        if (!parsed){
-            std::cout << "\nError: Cannot parse json content...\n";
-        } else {
-            if (root["gpa"].isNull()) {
-                jsonValid = false;
-                std::cout << "\nError: gpa.json does not have the necessary information...\n";
-            } else jsonValid = true;
-        }
+    ModuleStore gpaMap;
+    LoadStatus status = loadSavedModules(gpaMap);
+    if (status == LOAD_PARSE_ERROR){
+        std::cout << "\nError: Cannot parse json content...\n";
+    } else if (status == LOAD_MISSING_GPA) {
+        std::cout << "\nError: gpa.json does not have the necessary information...\n";
+    } else if (status == LOAD_INVALID_GRADE) {
+        std::cout << "\nError: gpa.json contains an invalid grade...\n";
     }
-    gpaHashMapStruc gpaMap;
-    float totalGPA = -1.0; // placeholder as if it's less than 0, it will print out N/A in the menu
-    if (jsonValid) {
-        Json::Value values = root["gpa"];
-        for(auto it = values.begin(); it != values.end(); it++) {
-            std::string moduleName = it.key().asString();
-
-            std::string grade = values[moduleName]["grade"].asString();
-            if (!checkIfUppercase(grade)) uppercaseInput(grade);
-            int credit = values[moduleName]["credit"].asInt();
-
-            gpaMap[moduleName] = std::make_tuple(grade, credit);
-        }
-    } 
+    bool jsonValid = (jsonFileExist && status == LOAD_OK) || !gpaMap.empty();
+    persister.start(gpaMap);
 
     std::string userInput = "";
     while (userInput != "F") {
-        totalGPA = calculateGPA(gpaMap);
-        printMenu(totalGPA, jsonValid);
+#ifdef GPA_DEBUG_AGGREGATE
+        verifyAggregate(gpaMap);
+#endif
+        printMenu(gpaMap.formattedGPA(), jsonValid);
         std::cout << "\nPlease enter your desired command: ";
         std::getline(std::cin, userInput); uppercaseInput(userInput);
         
@@ -267,19 +2315,19 @@ void mainProcess()
             while (continueAdding) {
                 std::string finalModuleName;
                 int finalCredit = 0;
-                std::string finalGrade;
+                GradeCode finalGrade = GradeCode::INVALID;
 
                 // adding the name of the module
                 while (continueAdding) {
                     std::string moduleName;
                     bool addedModuleName = false;
                     std::cout << "\nPlease enter the module name (x to cancel): ";
-                    std::getline(std::cin, moduleName); titleInput(moduleName);
-                    if (moduleName == "X") {
+                    std::getline(std::cin, moduleName);
+                    if (moduleName == "x" || moduleName == "X") {
                         continueAdding = false;
                         break;
                     }
-                    if (gpaMap.find(moduleName) != gpaMap.end()) {
+                    if (gpaMap.contains(moduleName)) {
                         std::cout << "Error: Module name already exists...\n";
                     } else if (!moduleName.empty()) {
                         while (1) {
@@ -319,7 +2367,7 @@ void mainProcess()
                             std::string confirmInput;
                             std::getline(std::cin, confirmInput); uppercaseInput(confirmInput);
                             if (confirmInput == "Y") {
-                                finalGrade = moduleGrade;
+                                finalGrade = internGrade(moduleGrade);
                                 addedGrade = true;
                                 break;
                             } else if (confirmInput == "N") {
@@ -373,9 +2421,9 @@ void mainProcess()
                 }
 
                 if (continueAdding) {
-                    std::cout << "\nAdded module, " << finalModuleName << ", with grade, " << finalGrade << ", and credits, " << finalCredit << ", to gpa.json...\n";
-                    gpaMap[finalModuleName] = std::make_tuple(finalGrade, finalCredit);
-                    saveToPC(gpaMap);
+                    std::cout << "\nAdded module, " << finalModuleName << ", with grade, " << gradeName(finalGrade) << ", and credits, " << finalCredit << ", to gpa.json...\n";
+                    gpaMap.set(finalModuleName, finalGrade, finalCredit);
+                    saveChanges(gpaMap);
                     std::cout << "------------------------------------------------------------------------------------\n";
                     jsonValid = true;
                 }
@@ -385,23 +2433,25 @@ void mainProcess()
             // edit existing module result
             bool readGPA = true;
             while (1) {
-                if (readGPA) readJsonGPAData(gpaMap);
+                if (readGPA) printModulePromptList(gpaMap);
                 std::string moduleToEdit;
                 std::cout << "\nPlease enter the module name that you would to edit (X to cancel): "; 
-                std::getline(std::cin, moduleToEdit); titleInput(moduleToEdit);
-                if (moduleToEdit == "X") break;
+                std::getline(std::cin, moduleToEdit);
+                if (moduleToEdit == "x" || moduleToEdit == "X") break;
 
-                if (gpaMap.find(moduleToEdit) != gpaMap.end()) {
+                moduleToEdit = resolveModuleName(gpaMap, moduleToEdit);
+                if (!moduleToEdit.empty()) {
                     bool editedInfo = false;
                     std::string initialModName = moduleToEdit;
-                    std::string initialGrade = std::get<0>(gpaMap[moduleToEdit]);
-                    int initialCredit = std::get<1>(gpaMap[moduleToEdit]);
+                    GradeCode initialGrade = gpaMap.find(moduleToEdit)->grade;
+                    int initialCredit = gpaMap.find(moduleToEdit)->credit;
 
                     while (1) {
                         std::cout << "----------------------------------------------\n\n";
                         std::cout << "Currently editing " << moduleToEdit << "...\n";
-                        std::cout << "Current grade: " << std::get<0>(gpaMap[moduleToEdit]) << "\n";
-                        std::cout << "Current credit: " << std::get<1>(gpaMap[moduleToEdit]) << "\n\n";
+                        const ModuleRecord current = *gpaMap.find(moduleToEdit);
+                        std::cout << "Current grade: " << gradeName(current.grade) << "\n";
+                        std::cout << "Current credit: " << current.credit << "\n\n";
                         std::cout << "Commands:\n";
                         std::cout << "\"n\" to edit the module name\n";
                         std::cout << "\"g\" to edit the grade\n";
@@ -422,14 +2472,14 @@ void mainProcess()
                             while (1) {
                                 std::string newModuleName;
                                 std::cout << "Enter new module name (x to cancel): "; 
-                                std::getline(std::cin, newModuleName); titleInput(newModuleName);
-                                if (gpaMap.find(newModuleName) != gpaMap.end()) {
+                                std::getline(std::cin, newModuleName);
+                                bool recased = newModuleName != moduleToEdit && foldedEquals(newModuleName, moduleToEdit); // only the casing changes
+                                if (gpaMap.contains(newModuleName) && !recased) {
                                     std::cout << "Error: Module name already exists...\n";
-                                } else if (newModuleName == "X") {
+                                } else if (newModuleName == "x" || newModuleName == "X") {
                                     break;
                                 } else if (!newModuleName.empty()) {
-                                    gpaMap[newModuleName] = gpaMap[moduleToEdit];
-                                    gpaMap.erase(moduleToEdit);
+                                    gpaMap.rename(moduleToEdit, newModuleName);
                                     moduleToEdit = newModuleName;
                                     editedInfo = true;
                                     break;
@@ -447,7 +2497,7 @@ void mainProcess()
                                 } else if (!checkIfInputIsValidGrade(newGrade)) {
                                     std::cout << "Error: Invalid grade...\n";
                                 } else {
-                                    std::get<0>(gpaMap[moduleToEdit]) = newGrade;
+                                    gpaMap.set(moduleToEdit, internGrade(newGrade), current.credit);
                                     editedInfo = true;
                                     break;
                                 }
@@ -461,7 +2511,7 @@ void mainProcess()
                                 if (checkIfInputIsInt(newCredit)) {
                                     int newCreditVal = std::stoi(newCredit);
                                     if (newCreditVal >= 0 && newCreditVal <= 99) {
-                                        std::get<1>(gpaMap[moduleToEdit]) = newCreditVal;
+                                        gpaMap.set(moduleToEdit, current.grade, newCreditVal);
                                         editedInfo = true;
                                         break;
                                     } else {
@@ -479,7 +2529,11 @@ void mainProcess()
                             std::string confirmSave;
                             std::getline(std::cin, confirmSave); uppercaseInput(confirmSave);
                             if (confirmSave == "Y") {
-                                saveToPC(gpaMap);
+                                saveChanges(gpaMap);
+                                // the saved values become the new baseline for reverting
+                                initialModName = moduleToEdit;
+                                initialGrade = gpaMap.find(moduleToEdit)->grade;
+                                initialCredit = gpaMap.find(moduleToEdit)->credit;
                                 editedInfo = false;
                             } else if (confirmSave == "N") {
                                 std::cout << "Saving of changes aborted...\n";
@@ -492,8 +2546,8 @@ void mainProcess()
                             std::string confirmSave;
                             std::getline(std::cin, confirmSave); uppercaseInput(confirmSave);
                             if (confirmSave == "Y") {
-                                gpaMap.erase(moduleToEdit);
-                                gpaMap[initialModName] = std::make_tuple(initialGrade, initialCredit);
+                                if (moduleToEdit != initialModName) gpaMap.rename(moduleToEdit, initialModName);
+                                gpaMap.set(initialModName, initialGrade, initialCredit);
                                 moduleToEdit = initialModName;
                                 editedInfo = false;
                             } else if (confirmSave == "N") {
@@ -507,22 +2561,20 @@ void mainProcess()
                         }
                     }
                     break;
-                } else {
-                    std::cout << "Module not found!\n";
-                    readGPA = false;
-                }
+                } else readGPA = false;
             }
 
         } else if (userInput == "3" && jsonValid) {
             // remove module result
             bool readGPA = true;
             while (1) {
-                if (readGPA) readJsonGPAData(gpaMap);
+                if (readGPA) printModulePromptList(gpaMap);
                 std::string moduleToRemove;
                 std::cout << "\nPlease enter the module name that you would like to remove (X to cancel): "; 
-                std::getline(std::cin, moduleToRemove); titleInput(moduleToRemove);
-                if (moduleToRemove == "X") break;
-                if (gpaMap.find(moduleToRemove) != gpaMap.end()) {
+                std::getline(std::cin, moduleToRemove);
+                if (moduleToRemove == "x" || moduleToRemove == "X") break;
+                moduleToRemove = resolveModuleName(gpaMap, moduleToRemove);
+                if (!moduleToRemove.empty()) {
                     std::string confirmErase;
                     while (1) {
                         std::cout << "Are you sure you want to remove the module, " << moduleToRemove << "? (Y/N): "; 
@@ -534,24 +2586,613 @@ void mainProcess()
                     if (confirmErase == "Y") {
                         gpaMap.erase(moduleToRemove);
                         std::cout << "Module " << moduleToRemove << " has been removed.\n";
-                        saveToPC(gpaMap);
+                        saveChanges(gpaMap);
                     } else std::cout << "Module " << moduleToRemove << " will NOT be removed.\n";
                     readGPA = true;
-                } else {
-                    std::cout << "Module not found!\n";
-                    readGPA = false;
-                }
+                } else readGPA = false;
             }
 
         } else if (userInput == "4" && jsonValid) {
             // read all module results
             readJsonGPAData(gpaMap);
 
+        } else if (userInput == "5") {
+            // bulk import of module results
+            std::string importFile;
+            std::cout << "\nColumns: module name, grade, credit (optional 4th column: term)\n";
+            std::cout << "Please enter the path of the CSV/TSV file (x to cancel): ";
+            std::getline(std::cin, importFile);
+            if (importFile == "x" || importFile == "X") continue;
+
+            FileView file;
+            if (!file.open(importFile)) {
+                std::cout << "Error: Cannot open " << importFile << "...\n";
+                continue;
+            }
+            ImportResult result = importModules(file.data(), file.size(), gpaMap, std::cout);
+            std::cout << "Imported " << result.imported << " module(s), skipped " << result.skipped << " row(s)...\n";
+            if (result.imported > 0) {
+                // a single write for the whole import instead of one per row
+                saveChanges(gpaMap);
+                jsonValid = true;
+            }
+
         } else if (userInput != "F") { 
             std::cout << "Invalid command input, please enter a valid command from the menu above.\n";
         } 
     }
+    if (persister.stop()) std::cout << "\nAll changes have been saved (version " << persister.durableVersion() << ")...\n";
+    else std::cout << "\nSome changes could not be saved, only version " << persister.durableVersion() << " was written...\n";
+}
+
+// splits a command into its words, a word in double quotes may contain spaces and \" or \\ for a quote or backslash
+// an unquoted word starting with # starts a comment that runs to the end of the line
+bool splitCommand(const std::string_view line, std::vector<std::string>& words, std::string& error)
+{
+    words.clear();
+    size_t i = 0;
+    while (true) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+        if (i == line.size() || line[i] == '#') return true;
+
+        std::string& word = words.emplace_back();
+        if (line[i] != '"') {
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') word += line[i++];
+            continue;
+        }
+        for (i++; i < line.size() && line[i] != '"'; i++) {
+            if (line[i] == '\\' && i + 1 < line.size()) i++;
+            word += line[i];
+        }
+        if (i == line.size()) {
+            error = "missing closing quote";
+            return false;
+        }
+        i++;
+    }
+}
+
+// runs one line of the command language used by --script:
+//   add NAME GRADE CREDIT               adds a module
+//   edit NAME name|grade|credit VALUE   changes one field of a module
+//   rm NAME                             removes a module
+//   get NAME                            prints "name<TAB>grade<TAB>credit"
+//   ls [name|grade|credit] [LIMIT]      prints every module as get does, in the given order
+//   gpa                                 prints "gpa<TAB>credits<TAB>modules"
+// names are matched without regard to case, blank lines and comments (from an unquoted word starting with #) do nothing
+// changes are saved straight away and without confirmation, output is appended to out and false is returned with
+// the reason in error if the command failed
+bool runCommand(ModuleStore& gpaMap, const std::vector<std::string>& words, TextBuilder& out, std::string& error);
+
+bool runCommand(ModuleStore& gpaMap, const std::string_view line, TextBuilder& out, std::string& error)
+{
+    static thread_local std::vector<std::string> words; // reused so that a command does not allocate its word list
+    error.clear();
+    if (!splitCommand(line, words, error)) return false;
+    return runCommand(gpaMap, words, out, error);
+}
+
+// get, ls and gpa only read the modules, so the daemon can answer them from a published snapshot
+bool isQueryCommand(const std::vector<std::string>& words)
+{
+    return !words.empty() && (words[0] == "get" || words[0] == "ls" || words[0] == "gpa");
+}
+
+// runs get, ls or gpa on either the live store or a snapshot's modules, formattedGPA is the snapshot's GPA or null
+// for the store's own cached one, which may only be used on the thread that changes the store
+bool runQuery(const ModuleStore& gpaMap, const std::string* formattedGPA, const std::vector<std::string>& words, TextBuilder& out, std::string& error)
+{
+    const std::string& command = words[0];
+    auto appendModule = [&out](std::string_view name, const ModuleRecord& record) {
+        out << name << '\t' << gradeName(record.grade) << '\t' << record.credit << '\n';
+    };
+    auto usage = [&error](const char* text) {
+        error = std::string("usage: ") + text;
+        return false;
+    };
+
+    if (command == "get") {
+        if (words.size() != 2) return usage("get NAME");
+        std::optional<ModuleRecord> record = gpaMap.find(words[1]);
+        if (!record) {
+            error = "module " + words[1] + " not found";
+            return false;
+        }
+        appendModule(gpaMap.displayName(words[1]), *record);
+
+    } else if (command == "ls") {
+        ModuleSort sort = SORT_BY_NAME;
+        size_t limit = gpaMap.size();
+        if (words.size() > 3 || (words.size() > 1 && !parseModuleSort(words[1], sort))) return usage("ls [name|grade|credit] [LIMIT]");
+        if (words.size() == 3) {
+            if (!checkIfInputIsInt(words[2]) || words[2].size() > 9) return usage("ls [name|grade|credit] [LIMIT]");
+            limit = std::stoul(words[2]);
+        }
+        gpaMap.forEachSorted(sort, 0, limit, appendModule);
+
+    } else {
+        if (words.size() != 1) return usage("gpa");
+        out << (formattedGPA ? *formattedGPA : gpaMap.formattedGPA()) << '\t' << gpaMap.totals().totalCredits << '\t' << gpaMap.size() << '\n';
+    }
+    return true;
+}
+
+// answers one request line from a snapshot, safe to call from several reader threads at once
+bool runQuery(const ModuleSnapshot& snapshot, const std::vector<std::string>& words, TextBuilder& out, std::string& error)
+{
+    if (words[0] == "ls") snapshot.prepareSorts();
+    return runQuery(snapshot.modules, &snapshot.gpa, words, out, error);
+}
+
+bool runCommand(ModuleStore& gpaMap, const std::vector<std::string>& words, TextBuilder& out, std::string& error)
+{
+    error.clear();
+    if (words.empty()) return true;
+
+    const std::string& command = words[0];
+    auto usage = [&error](const char* text) {
+        error = std::string("usage: ") + text;
+        return false;
+    };
+
+    if (command == "add") {
+        if (words.size() != 4) return usage("add NAME GRADE CREDIT");
+        GradeCode grade = internGrade(words[2]);
+        int credit = 0;
+        if (words[1].empty()) error = "module name cannot be empty";
+        else if (gpaMap.contains(words[1])) error = "module " + words[1] + " already exists";
+        else if (grade == GradeCode::INVALID) error = "invalid grade \"" + words[2] + "\"";
+        else if (!checkIfInputIsValidCredit(words[3], credit)) error = "invalid credit \"" + words[3] + "\"";
+        if (!error.empty()) return false;
+        gpaMap.set(words[1], grade, credit);
+
+    } else if (command == "edit") {
+        if (words.size() != 4) return usage("edit NAME name|grade|credit VALUE");
+        std::optional<ModuleRecord> record = gpaMap.find(words[1]);
+        if (!record) {
+            error = "module " + words[1] + " not found";
+            return false;
+        }
+        std::string moduleName(gpaMap.displayName(words[1]));
+        const std::string& field = words[2];
+        const std::string& value = words[3];
+        if (field == "name") {
+            if (value.empty()) error = "module name cannot be empty";
+            else if (!gpaMap.rename(moduleName, value)) error = "module " + value + " already exists";
+        } else if (field == "grade") {
+            GradeCode grade = internGrade(value);
+            if (grade == GradeCode::INVALID) error = "invalid grade \"" + value + "\"";
+            else gpaMap.set(moduleName, grade, record->credit);
+        } else if (field == "credit") {
+            int credit = 0;
+            if (!checkIfInputIsValidCredit(value, credit)) error = "invalid credit \"" + value + "\"";
+            else gpaMap.set(moduleName, record->grade, credit);
+        } else return usage("edit NAME name|grade|credit VALUE");
+        if (!error.empty()) return false;
+
+    } else if (command == "rm") {
+        if (words.size() != 2) return usage("rm NAME");
+        if (!gpaMap.erase(words[1])) {
+            error = "module " + words[1] + " not found";
+            return false;
+        }
+
+    } else if (isQueryCommand(words)) {
+        if (!runQuery(gpaMap, nullptr, words, out, error)) return false;
+
+    } else {
+        error = "unknown command \"" + command + "\"";
+        return false;
+    }
+
+    saveChanges(gpaMap);
+    return true;
+}
+
+// loads the saved modules for the script and daemon modes, which do not run on a gpa.json that does not load so
+// that it is never overwritten
+bool loadSavedModulesOrReport(ModuleStore& gpaMap)
+{
+    LoadStatus status = loadSavedModules(gpaMap);
+    if (status == LOAD_OK) return true;
+    std::cerr << "Error: " << jsonFile;
+    if (status == LOAD_INVALID_GRADE) std::cerr << " contains an invalid grade\n";
+    else if (status == LOAD_MISSING_GPA) std::cerr << " does not have the necessary information\n";
+    else std::cerr << " cannot be parsed\n";
+    return false;
+}
+
+// runs the commands read from in without any prompts, returns 1 if any of them failed
+// the output is written in large blocks and every error goes to stderr with its line number
+int runScript(std::istream& in)
+{
+    ModuleStore gpaMap;
+    if (!loadSavedModulesOrReport(gpaMap)) return 1;
+    persister.start(gpaMap);
+
+    TextBuilder out;
+    std::string line, error;
+    size_t lineNumber = 0;
+    bool failed = false;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!runCommand(gpaMap, line, out, error)) {
+            failed = true;
+            std::cerr << "Line " << lineNumber << ": " << error << "\n";
+        }
+        if (out.size() >= 64 * 1024) {
+            std::cout << out.str();
+            out.clear();
+        }
+    }
+    std::cout << out.str();
+    std::cout.flush();
+    if (!persister.stop()) failed = true;
+    return failed ? 1 : 0;
+}
+
+#ifdef __linux__
+// a connection to the daemon, with what it sent that is not a whole line yet and the responses not yet written
+// responses are written in request order, so one that follows a query still being answered by a reader waits in pending
+struct DaemonClient {
+    struct PendingResponse {
+        std::string text;
+        bool answered = false;
+    };
+
+    uint64_t id = 0; // tells answers for a closed connection apart from ones for a new connection on the same fd
+    std::string input;
+    std::string output;
+    std::deque<PendingResponse> pending;
+    uint64_t firstPending = 0; // sequence number of pending.front()
+    size_t awaiting = 0; // requests handed to the readers and not answered yet
+    bool finished = false; // the client will not send any more, it is disconnected once its responses are written
+
+    // no more requests are read from a client that does not read its responses
+    bool backlogged() const;
+
+    void respond(std::string&& text)
+    {
+        if (pending.empty()) output += text;
+        else pending.push_back({ std::move(text), true });
+    }
+
+    // moves the responses that are no longer waiting for an earlier one to the output
+    void release()
+    {
+        while (!pending.empty() && pending.front().answered) {
+            output += pending.front().text;
+            pending.pop_front();
+            firstPending++;
+        }
+    }
+};
+
+// a run of get, ls and gpa requests from one client, answered together from one snapshot by a reader thread
+struct DaemonQuery {
+    int fd = -1;
+    uint64_t clientId = 0;
+    uint64_t sequence = 0;
+    std::shared_ptr<const ModuleSnapshot> snapshot; // the modules as they were when the first of the requests arrived
+    std::vector<std::vector<std::string>> requests;
+    std::string response;
+};
+
+// the daemon's reader threads, which answer queries from published snapshots so that they never wait for the event
+// loop applying changes or for the persister writing them, answered queries are handed back through an eventfd
+class DaemonReaders {
+public:
+    DaemonReaders(const int notifyFd, const size_t count) : notifyFd(notifyFd)
+    {
+        for (size_t i = 0; i < count; i++) threads.emplace_back([this] { work(); });
+    }
+
+    ~DaemonReaders() { stop(); }
+
+    void submit(std::vector<DaemonQuery>& queries)
+    {
+        if (queries.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (DaemonQuery& query : queries) waiting.push_back(std::move(query));
+        }
+        queries.clear();
+        queued.notify_all();
+    }
+
+    void takeAnswered(std::vector<DaemonQuery>& queries)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queries.swap(answered);
+        answered.clear();
+    }
+
+    // queries that have not been picked up yet are dropped
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        for (std::thread& thread : threads) thread.join();
+        threads.clear();
+    }
+
+private:
+    void work()
+    {
+        TextBuilder out;
+        std::string error;
+        while (true) {
+            DaemonQuery query;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued.wait(lock, [this] { return stopping || !waiting.empty(); });
+                if (stopping) return;
+                query = std::move(waiting.front());
+                waiting.pop_front();
+            }
+
+            for (const std::vector<std::string>& words : query.requests) {
+                out.clear();
+                bool ok = runQuery(*query.snapshot, words, out, error);
+                query.response += out.str();
+                query.response += ok ? "OK\n" : "ERR " + error + "\n";
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                answered.push_back(std::move(query));
+            }
+            uint64_t one = 1;
+            ssize_t written = write(notifyFd, &one, sizeof(one));
+            (void)written; // the counter can only fail to be written if it is about to overflow, it is still readable then
+        }
+    }
+
+    const int notifyFd;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<DaemonQuery> waiting;
+    std::vector<DaemonQuery> answered;
+    bool stopping = false;
+};
+
+// the longest request line accepted, a client sending more without a newline is disconnected
+const size_t daemonMaxLine = 64 * 1024;
+// how far a client's responses may back up before the daemon stops reading its requests until it catches up
+const size_t daemonMaxBacklog = 1024 * 1024;
+const size_t daemonMaxAwaiting = 1024;
+
+bool DaemonClient::backlogged() const { return output.size() > daemonMaxBacklog || awaiting > daemonMaxAwaiting; }
+
+// writes as much of the pending output as the socket takes, false if the client is gone
+bool flushDaemonClient(const int fd, DaemonClient& client)
+{
+    size_t written = 0;
+    while (written < client.output.size()) {
+        ssize_t n = send(fd, client.output.data() + written, client.output.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return false;
+        written += n;
+    }
+    client.output.erase(0, written);
+    return true;
+}
+
+// serves the command language of --script over a Unix domain socket, one command per line, with every response being
+// the command's output followed by a line with "OK" or "ERR reason"
+// a single thread runs an epoll loop over the listening socket, the clients and a signalfd for SIGINT/SIGTERM, so the
+// modules stay loaded between requests and changes are saved through the same persister as the other modes
+// the loop applies every change itself, while runs of get/ls/gpa are answered by reader threads from a snapshot of the
+// modules published as they were when the run arrived
+int runDaemon(const std::string& socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: the socket path must be 1 to " << sizeof(address.sun_path) - 1 << " characters long\n";
+        return 1;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    // a socket file left behind by a daemon that did not shut down cleanly is replaced, but only once connecting
+    // to it is refused, a daemon that still accepts connections on it keeps serving
+    struct stat info;
+    if (stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, (sockaddr*)&address, sizeof(address)) == 0;
+        bool stale = !live && probe >= 0 && errno == ECONNREFUSED;
+        if (probe >= 0) close(probe);
+        if (live) {
+            std::cerr << "Error: another daemon is already serving on " << socketPath << "\n";
+            return 1;
+        }
+        if (stale) unlink(socketPath.c_str());
+    }
+
+    ModuleStore gpaMap;
+    if (!loadSavedModulesOrReport(gpaMap)) return 1;
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Error: cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (listener >= 0) close(listener);
+        return 1;
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listener, &event);
+    event.data.fd = signalFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+    int answerFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    event.data.fd = answerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, answerFd, &event);
+
+    // a snapshot is only published when a query arrives after a change, so a run of changes costs one copy at most
+    SnapshotPublisher publisher;
+    publisher.publish(gpaMap);
+    uint64_t publishedGeneration = gpaMap.getCounters().generation;
+    size_t cores = std::thread::hardware_concurrency();
+    DaemonReaders readers(answerFd, cores > 2 ? cores - 1 : 1);
+    std::vector<DaemonQuery> queries, answered;
+    uint64_t nextClientId = 0;
+
+    persister.start(gpaMap);
+    std::cerr << "Serving " << jsonFile << " on " << socketPath << "...\n";
+
+    std::unordered_map<int, DaemonClient> clients;
+    auto disconnect = [&clients, epollFd](int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        clients.erase(fd);
+    };
+    // only asks to be told about writability while there is output waiting
+    auto watch = [epollFd](int fd, const DaemonClient& client) {
+        epoll_event clientEvent = {};
+        bool reading = !client.finished && !client.backlogged();
+        clientEvent.events = (reading ? (uint32_t)(EPOLLIN | EPOLLRDHUP) : 0) | (client.output.empty() ? 0 : (uint32_t)EPOLLOUT);
+        clientEvent.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &clientEvent);
+    };
+
+    TextBuilder out;
+    std::string error;
+    std::vector<std::string> words;
+    char buffer[16 * 1024];
+    epoll_event events[64];
+    // every whole line is a request, answered in order, consecutive queries are collected into one run
+    auto handleRequests = [&](int fd, DaemonClient& client) {
+        size_t start = 0, end;
+        size_t run = queries.size(); // the run being collected for this client, if any
+        while ((end = client.input.find('\n', start)) != std::string::npos) {
+            std::string_view line = std::string_view(client.input).substr(start, end - start);
+            start = end + 1;
+            error.clear();
+            bool split = splitCommand(line, words, error);
+            if (split && isQueryCommand(words)) {
+                if (run == queries.size()) {
+                    if (gpaMap.getCounters().generation != publishedGeneration) {
+                        publisher.publish(gpaMap);
+                        publishedGeneration = gpaMap.getCounters().generation;
+                    }
+                    DaemonQuery& query = queries.emplace_back();
+                    query.fd = fd;
+                    query.clientId = client.id;
+                    query.sequence = client.firstPending + client.pending.size();
+                    query.snapshot = publisher.acquire();
+                    client.pending.emplace_back();
+                }
+                queries[run].requests.push_back(words);
+                client.awaiting++;
+                continue;
+            }
+            run = queries.size();
+            out.clear();
+            bool ok = split && runCommand(gpaMap, words, out, error);
+            client.respond(out.str() + (ok ? "OK\n" : "ERR " + error + "\n"));
+        }
+        client.input.erase(0, start);
+    };
+
+    bool running = true;
+    while (running) {
+        int ready = epoll_wait(epollFd, events, 64, -1);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) break;
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == signalFd) {
+                running = false;
+            } else if (fd == answerFd) {
+                uint64_t count;
+                ssize_t n = read(answerFd, &count, sizeof(count));
+                (void)n; // only resets the counter, the answers themselves are taken below
+                readers.takeAnswered(answered);
+                for (DaemonQuery& query : answered) {
+                    auto found = clients.find(query.fd);
+                    if (found == clients.end() || found->second.id != query.clientId) continue;
+                    DaemonClient& client = found->second;
+                    client.awaiting -= query.requests.size();
+                    DaemonClient::PendingResponse& response = client.pending[query.sequence - client.firstPending];
+                    response.text = std::move(query.response);
+                    response.answered = true;
+                    client.release();
+                    if (!flushDaemonClient(query.fd, client) || (client.finished && client.output.empty() && client.pending.empty())) disconnect(query.fd);
+                    else watch(query.fd, client);
+                }
+                answered.clear();
+            } else if (fd == listener) {
+                int clientFd;
+                while ((clientFd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    epoll_event clientEvent = {};
+                    clientEvent.events = EPOLLIN | EPOLLRDHUP;
+                    clientEvent.data.fd = clientFd;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &clientEvent);
+                    clients[clientFd].id = ++nextClientId;
+                }
+            } else {
+                auto found = clients.find(fd);
+                if (found == clients.end()) continue;
+                DaemonClient& client = found->second;
+
+                bool failed = (events[i].events & EPOLLERR) != 0;
+                if (!failed && !client.finished && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+                    // the requests are handled after every read, so that a line longer than daemonMaxLine is caught
+                    // as it arrives and reading stops as soon as the client's responses back up
+                    while (!client.backlogged()) {
+                        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                        if (n < 0 && errno == EINTR) continue;
+                        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                        if (n <= 0) {
+                            client.finished = true;
+                            failed = n < 0;
+                            break;
+                        }
+                        client.input.append(buffer, n);
+                        handleRequests(fd, client);
+                        if (client.input.size() > daemonMaxLine) {
+                            failed = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (failed || !flushDaemonClient(fd, client) || (client.finished && client.output.empty() && client.pending.empty())) disconnect(fd);
+                else watch(fd, client);
+            }
+        }
+        readers.submit(queries);
+    }
+
+    readers.stop();
+    while (!clients.empty()) disconnect(clients.begin()->first);
+    close(listener);
+    unlink(socketPath.c_str());
+    close(signalFd);
+    close(answerFd);
+    close(epollFd);
+    if (!persister.stop()) {
+        std::cerr << "Some changes could not be saved, only version " << persister.durableVersion() << " was written...\n";
+        return 1;
+    }
+    std::cerr << "All changes have been saved (version " << persister.durableVersion() << ")...\n";
+    return 0;
 }
+#endif
 
 void logError(std::string errorMessage) 
 {
@@ -574,8 +3215,257 @@ void logError(std::string errorMessage)
     errorLog.close();
 }
 
-int main() 
+// one result line per transcript: path, GPA, graded credits and number of modules, or path, ERROR and the reason
+std::string processTranscript(const std::string& fileName)
+{
+    ModuleStore gpaMap;
+    LoadStatus status = loadGPAFile(fileName, gpaMap);
+    if (status == LOAD_PARSE_ERROR) return fileName + "\tERROR\tcannot parse file";
+    if (status == LOAD_MISSING_GPA) return fileName + "\tERROR\tmissing gpa data";
+    if (status == LOAD_INVALID_GRADE) return fileName + "\tERROR\tinvalid grade";
+
+    const GPAAggregate& agg = gpaMap.totals();
+    TextBuilder line;
+    line << fileName << '\t' << formatGPA(agg) << '\t' << agg.totalCredits << '\t' << gpaMap.size();
+    return line.str();
+}
+
+// expands directories into the .json files (and .bin files without a .json) directly inside them, and list files (prefixed with @) into their lines
+bool collectTranscripts(const std::vector<std::string>& inputs, std::vector<std::string>& files)
+{
+    for (const std::string& input : inputs) {
+        if (input.size() > 1 && input[0] == '@') {
+            std::ifstream list(input.substr(1));
+            if (!list) {
+                std::cerr << "Error: cannot open list file " << input.substr(1) << "\n";
+                return false;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) files.push_back(line);
+            }
+        } else if (std::filesystem::is_directory(input)) {
+            std::vector<std::string> dirFiles;
+            std::vector<std::filesystem::path> binaries;
+            for (const auto& entry : std::filesystem::directory_iterator(input)) {
+                std::string extension = entry.path().extension().string();
+                if (!entry.is_regular_file()) continue;
+                if (extension == ".json") dirFiles.push_back(entry.path().string());
+                else if (extension == ".bin") binaries.push_back(entry.path());
+            }
+            // saving writes a .bin copy next to every .json, which is the same transcript and is only listed on its own
+            for (std::filesystem::path& binary : binaries) {
+                if (!std::filesystem::is_regular_file(std::filesystem::path(binary).replace_extension(".json"))) dirFiles.push_back(binary.string());
+            }
+            std::sort(dirFiles.begin(), dirFiles.end());
+            files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+        } else {
+            files.push_back(input);
+        }
+    }
+    return true;
+}
+
+// fixed size pool where every worker owns a deque of task indexes and steals from the other workers once its own deque is empty
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(const unsigned int threadCount) : workers(threadCount == 0 ? 1 : threadCount) {}
+
+    size_t size() const { return workers.size(); }
+
+    // runs task(index, workerId) for every index in [0, taskCount) and returns once all of them are done
+    void run(const size_t taskCount, const std::function<void(size_t, size_t)>& task)
+    {
+        // each worker starts with a contiguous block so that neighbouring files are usually handled by the same thread
+        size_t blockSize = (taskCount + workers.size() - 1) / workers.size();
+        for (size_t w = 0; w < workers.size(); w++) {
+            for (size_t i = w * blockSize; i < taskCount && i < (w + 1) * blockSize; i++) workers[w].tasks.push_back(i);
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workers.size(); w++) threads.emplace_back([this, w, &task] { work(w, task); });
+        work(0, task);
+        for (auto& thread : threads) thread.join();
+    }
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    bool popOwn(const size_t w, size_t& index)
+    {
+        std::lock_guard<std::mutex> guard(workers[w].lock);
+        if (workers[w].tasks.empty()) return false;
+        index = workers[w].tasks.back();
+        workers[w].tasks.pop_back();
+        return true;
+    }
+
+    bool steal(const size_t w, size_t& index)
+    {
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            Worker& victim = workers[(w + offset) % workers.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.tasks.empty()) continue;
+            index = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    // tasks are never added while running, so a worker can stop once there is nothing left to steal
+    void work(const size_t w, const std::function<void(size_t, size_t)>& task)
+    {
+        size_t index;
+        while (popOwn(w, index) || steal(w, index)) task(index, w);
+    }
+
+    std::vector<Worker> workers;
+};
+
+// computes the GPA of every transcript without any prompts, returns 1 if any of them could not be loaded
+int runBatch(const std::vector<std::string>& inputs, const std::string& reportFile, const size_t jobs)
+{
+    std::vector<std::string> files;
+    if (!collectTranscripts(inputs, files)) return 2;
+
+    std::ofstream report;
+    if (!reportFile.empty()) {
+        report.open(reportFile, std::ios::trunc);
+        if (!report) {
+            std::cerr << "Error: cannot open report file " << reportFile << "\n";
+            return 2;
+        }
+    }
+    std::ostream& out = reportFile.empty() ? std::cout : report;
+
+    // every worker keeps its own results, they are only put back in input order once all files are done
+    // no more threads than there are files to give them
+    WorkStealingPool pool((unsigned int)std::min<size_t>(jobs, files.size()));
+    std::vector<std::vector<std::pair<size_t, std::string>>> workerResults(pool.size());
+    // an exception must not leave a worker thread, it would terminate the whole batch
+    pool.run(files.size(), [&files, &workerResults](size_t index, size_t worker) {
+        std::string line;
+        try {
+            line = processTranscript(files[index]);
+        } catch (const std::exception& e) {
+            std::string reason = e.what();
+            std::replace_if(reason.begin(), reason.end(), [](char c) { return c == '\n' || c == '\t'; }, ' ');
+            line = files[index] + "\tERROR\t" + reason;
+        }
+        workerResults[worker].emplace_back(index, std::move(line));
+    });
+
+    std::vector<std::string> lines(files.size());
+    for (auto& results : workerResults) {
+        for (auto& result : results) lines[result.first] = std::move(result.second);
+    }
+
+    bool failed = false;
+    for (const std::string& line : lines) {
+        if (line.find("\tERROR\t") != std::string::npos) failed = true;
+        out << line << "\n";
+    }
+    out.flush();
+    return failed ? 1 : 0;
+}
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage:\n";
+    std::cerr << "  " << program << " [--sort name|grade|credit] [--limit N] [--page-size N]\n";
+    std::cerr << "      interactive mode using gpa.json, the options apply to the module listing\n";
+    std::cerr << "  " << program << " --script [FILE]\n";
+    std::cerr << "      runs the commands in FILE (or stdin) on gpa.json without prompts: add NAME GRADE CREDIT,\n";
+    std::cerr << "      edit NAME name|grade|credit VALUE, rm NAME, get NAME, ls [name|grade|credit] [LIMIT] and gpa\n";
+#ifdef __linux__
+    std::cerr << "  " << program << " --serve SOCKET\n";
+    std::cerr << "      serves the --script commands on a Unix domain socket, each answered with its output and OK or ERR\n";
+#endif
+    std::cerr << "  " << program << " --batch [--report FILE] [--jobs N] <transcript|directory|@listfile>...\n";
+    std::cerr << "      prints \"path<TAB>gpa<TAB>credits<TAB>modules\" (or \"path<TAB>ERROR<TAB>reason\") per transcript\n";
+}
+
+#ifndef GPA_NO_MAIN // defined by the benchmarks that include this file
+int main(int argc, char* argv[]) 
 {   
+    if (argc > 1) {
+        std::vector<std::string> inputs;
+        std::string reportFile;
+        size_t jobs = std::thread::hardware_concurrency();
+        std::string socketPath;
+        bool batch = false, script = false;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--batch") batch = true;
+            else if (arg == "--script") script = true;
+#ifdef __linux__
+            else if (arg == "--serve" && i + 1 < argc) socketPath = argv[++i];
+#endif
+            else if (arg == "--report" && i + 1 < argc) reportFile = argv[++i];
+            else if (arg == "--jobs" && i + 1 < argc && parseCount(argv[i + 1], maxJobs, jobs)) i++;
+            else if (arg == "--limit" && i + 1 < argc && parseCount(argv[i + 1], std::numeric_limits<size_t>::max(), listOptions.limit)) i++;
+            else if (arg == "--page-size" && i + 1 < argc && parseCount(argv[i + 1], std::numeric_limits<size_t>::max(), listOptions.pageSize)) i++;
+            else if (arg == "--sort" && i + 1 < argc && parseModuleSort(argv[i + 1], listOptions.sort)) i++;
+            else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+                printUsage(argv[0]);
+                return 2;
+            } else inputs.push_back(arg);
+        }
+        int modes = batch + script + !socketPath.empty();
+        bool validArguments = modes <= 1 && (batch ? !inputs.empty() : script ? inputs.size() <= 1 : inputs.empty());
+        if (!validArguments) {
+            printUsage(argv[0]);
+            return 2;
+        }
+
+#ifdef __linux__
+        if (!socketPath.empty()) {
+            try {
+                return runDaemon(socketPath);
+            } catch (const std::exception& e) {
+                std::cerr << "Error encountered: " << e.what() << "\n";
+                persister.stop();
+                logError(e.what());
+                return 1;
+            }
+        }
+#endif
+
+        if (script) {
+            std::ios::sync_with_stdio(false);
+            try {
+                if (inputs.empty()) return runScript(std::cin);
+                std::ifstream file(inputs[0]);
+                if (!file) {
+                    std::cerr << "Error: cannot open " << inputs[0] << "\n";
+                    return 1;
+                }
+                return runScript(file);
+            } catch (const std::exception& e) {
+                std::cerr << "Error encountered: " << e.what() << "\n";
+                persister.stop();
+                logError(e.what());
+                return 1;
+            }
+        }
+
+        if (batch) {
+            std::ios::sync_with_stdio(false);
+            try {
+                return runBatch(inputs, reportFile, jobs);
+            } catch (const std::exception& e) {
+                std::cerr << "Error encountered: " << e.what() << "\n";
+                logError(e.what());
+                return 1;
+            }
+        }
+    }
+
     std::cout << "========================== GPA Calculator v" << version << " ==========================\n";
     std::cout << "================ https://github.com/KJHJason/GPACalculator ================\n";
     std::cout << "============================ Author: KJHJason =============================\n";
@@ -585,21 +3475,25 @@ int main()
     } catch(const std::runtime_error& re) {
         std::cout << "\nRuntime error encountered: " << re.what();
         pEnd();
+        persister.stop();
         logError(re.what());
         shutdown();
         return 1;
     } catch (const std::exception& e) {
         std::cout << "\nError encountered: " << e.what();
         pEnd();
+        persister.stop();
         logError(e.what());
         shutdown();
         return 1;
     } catch(...) {
         std::cout << "\nUnknown error encountered.";
         pEnd();
+        persister.stop();
         shutdown();
         return 1;
     }
     shutdown();
     return 0;
-}
\ No newline at end of file
+}
+#endif